@@ -0,0 +1,220 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/memus.
+ *
+ * adriagipas/memus is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/memus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/memus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  framehash.c - Implementació de 'framehash.h'.
+ *
+ */
+
+
+#include <errno.h>
+#include <glib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+#include "framehash.h"
+
+
+
+
+/**********/
+/* MACROS */
+/**********/
+
+#define LINE_SIZE 128
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+static struct
+{
+
+  bool           enabled;
+  bool           write;
+  bool           ok;
+  int            period;
+  gchar         *fn;
+  FILE          *f;
+  unsigned long  frames;
+  unsigned long  lines;
+  GChecksum     *video;
+  GChecksum     *audio;
+  
+} _fh;
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static void
+mismatch (
+          const char *msg
+          )
+{
+
+  if ( _fh.ok )
+    warning ( "'%s' (línia %lu, fotograma %lu): %s",
+              _fh.fn, _fh.lines, _fh.frames, msg );
+  _fh.ok= false;
+  
+} // end mismatch
+
+
+static void
+flush (void)
+{
+
+  char line[LINE_SIZE], golden[LINE_SIZE];
+  
+  
+  snprintf ( line, LINE_SIZE, "%lu %s %s\n", _fh.frames,
+             g_checksum_get_string ( _fh.video ),
+             g_checksum_get_string ( _fh.audio ) );
+  g_checksum_reset ( _fh.video );
+  g_checksum_reset ( _fh.audio );
+  ++_fh.lines;
+  if ( _fh.write )
+    {
+      if ( fputs ( line, _fh.f ) == EOF )
+        error ( "no s'ha pogut escriure en '%s': %s",
+                _fh.fn, strerror ( errno ) );
+    }
+  else if ( fgets ( golden, LINE_SIZE, _fh.f ) == NULL )
+    mismatch ( "el fitxer de referència s'ha acabat" );
+  else if ( strcmp ( line, golden ) != 0 )
+    mismatch ( "el hash no coincideix" );
+  
+} // end flush
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+bool
+close_framehash (void)
+{
+
+  char golden[LINE_SIZE];
+  bool ret;
+  
+  
+  if ( !_fh.enabled ) return true;
+
+  // Últim període incomplet.
+  if ( _fh.frames%_fh.period != 0 ) flush ();
+  
+  // Comprova que no falten línies.
+  if ( !_fh.write && fgets ( golden, LINE_SIZE, _fh.f ) != NULL )
+    mismatch ( "el fitxer de referència té més fotogrames" );
+  if ( fclose ( _fh.f ) != 0 && _fh.write )
+    error ( "no s'ha pogut acabar d'escriure '%s': %s",
+            _fh.fn, strerror ( errno ) );
+  g_checksum_free ( _fh.video );
+  g_checksum_free ( _fh.audio );
+  g_free ( _fh.fn );
+  ret= _fh.ok;
+  _fh.enabled= false;
+
+  return ret;
+  
+} // end close_framehash
+
+
+void
+init_framehash (
+                const char *fn,
+                const bool  write,
+                const int   period
+                )
+{
+
+  _fh.f= fopen ( fn, write ? "w" : "r" );
+  if ( _fh.f == NULL )
+    error ( "no s'ha pogut obrir '%s': %s", fn, strerror ( errno ) );
+  _fh.enabled= true;
+  _fh.write= write;
+  _fh.ok= true;
+  _fh.period= period;
+  _fh.fn= g_strdup ( fn );
+  _fh.frames= 0;
+  _fh.lines= 0;
+  _fh.video= g_checksum_new ( G_CHECKSUM_MD5 );
+  _fh.audio= g_checksum_new ( G_CHECKSUM_MD5 );
+  
+} // end init_framehash
+
+
+bool
+framehash_enabled (void)
+{
+  return _fh.enabled;
+} // end framehash_enabled
+
+
+void
+framehash_video_data (
+                      const void   *data,
+                      const size_t  size
+                      )
+{
+  
+  if ( !_fh.enabled ) return;
+  g_checksum_update ( _fh.video, (const guchar *) data, size );
+  
+} // end framehash_video_data
+
+
+void
+framehash_video (
+                 const void   *data,
+                 const size_t  size
+                 )
+{
+
+  if ( !_fh.enabled ) return;
+  g_checksum_update ( _fh.video, (const guchar *) data, size );
+  if ( ++_fh.frames%_fh.period == 0 ) flush ();
+  
+} // end framehash_video
+
+
+void
+framehash_audio (
+                 const void   *data,
+                 const size_t  size
+                 )
+{
+  
+  if ( !_fh.enabled ) return;
+  g_checksum_update ( _fh.audio, (const guchar *) data, size );
+  
+} // end framehash_audio
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/memus.
+ *
+ * adriagipas/memus is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/memus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/memus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  framehash.h - Hashos de referència de la imatge i el so.
+ *
+ *  Durant una reproducció es calcula l'MD5 dels fotogrames i dels
+ *  blocs de so que el simulador passa al frontend. Cada 'period'
+ *  fotogrames, i al tancar per als fotogrames que queden, s'escriu
+ *  una línia
+ *
+ *    <fotograma> <md5 imatge> <md5 so>
+ *
+ *  en el fitxer de referència, o es compara amb la línia
+ *  corresponent d'un fitxer de referència ja existent.
+ *
+ */
+
+#ifndef __FRAMEHASH_H__
+#define __FRAMEHASH_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Acaba. Torna false si alguna línia no ha coincidit o falten o
+ * sobren línies respecte al fitxer de referència. Escrivint sempre
+ * torna cert.
+ */
+bool
+close_framehash (void);
+
+/* Si 'write' és cert crea el fitxer 'fn', si no el llig per a
+ * comparar. 'period' ha de ser major que 0.
+ */
+void
+init_framehash (
+                const char *fn,
+                const bool  write,
+                const int   period
+                );
+
+bool
+framehash_enabled (void);
+
+/* Afegeix dades a la imatge del fotograma actual sense acabar-lo
+ * (geometria, etc.).
+ */
+void
+framehash_video_data (
+                      const void   *data,
+                      const size_t  size
+                      );
+
+/* Afegeix un fotograma. */
+void
+framehash_video (
+                 const void   *data,
+                 const size_t  size
+                 );
+
+/* Afegeix un bloc de so al fotograma actual. */
+void
+framehash_audio (
+                 const void   *data,
+                 const size_t  size
+                 );
+
+#endif /* __FRAMEHASH_H__ */
@@ -0,0 +1,340 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/memus.
+ *
+ * adriagipas/memus is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/memus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/memus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  frametime.c - Implementació de 'frametime.h'.
+ *
+ */
+
+
+#include <errno.h>
+#include <glib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+#include "frametime.h"
+
+
+
+
+/**********/
+/* MACROS */
+/**********/
+
+// Fotogrames de la finestra per als percentils.
+#define WINDOW 128
+
+// Cada quants fotogrames s'actualitzen les línies del HUD.
+#define HUD_PERIOD 30
+
+// Etapes més el simulador.
+#define NCOLS (FRAMETIME_NSTAGES+1)
+#define COL_CORE FRAMETIME_NSTAGES
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+static struct
+{
+
+  bool           enabled;
+  bool           hud;
+  gchar         *csv_fn;
+  FILE          *csv;
+  unsigned long  frames;
+
+  // Fotograma actual. t0 == 0 indica que no ha començat.
+  gint64         t0;
+  gint64         stages[FRAMETIME_NSTAGES];
+
+  // Finestra dels últims fotogrames.
+  gint64         total[WINDOW];
+  gint64         cols[WINDOW][NCOLS];
+  int            N;
+  int            p;
+
+  char           lines[FRAMETIME_HUD_LINES][FRAMETIME_HUD_COLS+1];
+
+} _ft;
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static int
+cmp_gint64 (
+            const void *a,
+            const void *b
+            )
+{
+
+  gint64 va,vb;
+
+
+  va= *((const gint64 *) a);
+  vb= *((const gint64 *) b);
+
+  return va < vb ? -1 : (va > vb ? 1 : 0);
+
+} // end cmp_gint64
+
+
+// En mil·lisegons, limitat perquè càpiga en la línia.
+static double
+to_ms (
+       const gint64 usecs
+       )
+{
+
+  double ret;
+
+
+  ret= usecs/1000.0;
+
+  return ret > 99.9 ? 99.9 : ret;
+
+} // end to_ms
+
+
+static void
+update_hud_lines (void)
+{
+
+  static const char *LABELS[NCOLS]= {"COP","ESC","PRE","SO","DOR","SIM"};
+
+  gint64 sorted[WINDOW];
+  double mean[NCOLS];
+  int i,j;
+
+
+  // Percentils del temps total.
+  memcpy ( sorted, _ft.total, _ft.N*sizeof(gint64) );
+  qsort ( sorted, _ft.N, sizeof(gint64), cmp_gint64 );
+  snprintf ( _ft.lines[0], FRAMETIME_HUD_COLS+1, "P50 %4.1f P95 %4.1f",
+             to_ms ( sorted[(_ft.N*50)/100] ),
+             to_ms ( sorted[(_ft.N*95)/100] ) );
+  snprintf ( _ft.lines[1], FRAMETIME_HUD_COLS+1, "P99 %4.1f MAX %4.1f",
+             to_ms ( sorted[(_ft.N*99)/100] ),
+             to_ms ( sorted[_ft.N-1] ) );
+
+  // Mitjana de cada etapa.
+  for ( j= 0; j < NCOLS; ++j )
+    {
+      mean[j]= 0.0;
+      for ( i= 0; i < _ft.N; ++i )
+        mean[j]+= (double) _ft.cols[i][j];
+      mean[j]/= _ft.N;
+    }
+  snprintf ( _ft.lines[2], FRAMETIME_HUD_COLS+1, "%-4s%4.1f %-4s%4.1f",
+             LABELS[COL_CORE], to_ms ( (gint64) mean[COL_CORE] ),
+             LABELS[FRAMETIME_COPY], to_ms ( (gint64) mean[FRAMETIME_COPY] ) );
+  snprintf ( _ft.lines[3], FRAMETIME_HUD_COLS+1, "%-4s%4.1f %-4s%4.1f",
+             LABELS[FRAMETIME_SCALER],
+             to_ms ( (gint64) mean[FRAMETIME_SCALER] ),
+             LABELS[FRAMETIME_PRESENT],
+             to_ms ( (gint64) mean[FRAMETIME_PRESENT] ) );
+  snprintf ( _ft.lines[4], FRAMETIME_HUD_COLS+1, "%-4s%4.1f %-4s%4.1f",
+             LABELS[FRAMETIME_SOUND],
+             to_ms ( (gint64) mean[FRAMETIME_SOUND] ),
+             LABELS[FRAMETIME_SLEEP],
+             to_ms ( (gint64) mean[FRAMETIME_SLEEP] ) );
+
+} // end update_hud_lines
+
+
+static void
+write_csv_row (
+               const gint64 total,
+               const gint64 cols[NCOLS]
+               )
+{
+
+  int ret;
+
+
+  ret= fprintf ( _ft.csv, "%lu,%ld,%ld,%ld,%ld,%ld,%ld,%ld\n",
+                 _ft.frames, (long) total, (long) cols[COL_CORE],
+                 (long) cols[FRAMETIME_COPY], (long) cols[FRAMETIME_SCALER],
+                 (long) cols[FRAMETIME_PRESENT], (long) cols[FRAMETIME_SOUND],
+                 (long) cols[FRAMETIME_SLEEP] );
+  if ( ret < 0 )
+    error ( "no s'ha pogut escriure en '%s': %s",
+            _ft.csv_fn, strerror ( errno ) );
+
+} // end write_csv_row
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+void
+close_frametime (void)
+{
+
+  if ( !_ft.enabled ) return;
+  if ( _ft.csv != NULL )
+    {
+      if ( fclose ( _ft.csv ) != 0 )
+        error ( "no s'ha pogut acabar d'escriure '%s': %s",
+                _ft.csv_fn, strerror ( errno ) );
+      g_free ( _ft.csv_fn );
+    }
+  _ft.enabled= false;
+
+} // end close_frametime
+
+
+void
+init_frametime (
+                const bool  hud,
+                const char *csv_fn
+                )
+{
+
+  int i;
+
+
+  _ft.enabled= true;
+  _ft.hud= hud;
+  _ft.csv= NULL;
+  _ft.csv_fn= NULL;
+  if ( csv_fn != NULL )
+    {
+      _ft.csv= fopen ( csv_fn, "w" );
+      if ( _ft.csv == NULL )
+        error ( "no s'ha pogut crear '%s': %s", csv_fn, strerror ( errno ) );
+      _ft.csv_fn= g_strdup ( csv_fn );
+      fprintf ( _ft.csv, "fotograma,total,simulador,copia,escalat,"
+                "presentacio,so,espera\n" );
+    }
+  _ft.frames= 0;
+  _ft.N= 0;
+  _ft.p= 0;
+  for ( i= 0; i < FRAMETIME_HUD_LINES; ++i )
+    _ft.lines[i][0]= '\0';
+  frametime_restart ();
+
+} // end init_frametime
+
+
+bool
+frametime_hud_enabled (void)
+{
+  return _ft.enabled && _ft.hud;
+} // end frametime_hud_enabled
+
+
+int64_t
+frametime_begin (void)
+{
+  return _ft.enabled ? (int64_t) g_get_monotonic_time () : 0;
+} // end frametime_begin
+
+
+void
+frametime_end (
+               const frametime_stage_t stage,
+               const int64_t           t0
+               )
+{
+
+  if ( !_ft.enabled ) return;
+  _ft.stages[stage]+= g_get_monotonic_time () - (gint64) t0;
+
+} // end frametime_end
+
+
+void
+frametime_frame (void)
+{
+
+  gint64 now,total,*cols;
+  int i;
+
+
+  if ( !_ft.enabled ) return;
+
+  now= g_get_monotonic_time ();
+  if ( _ft.t0 != 0 )
+    {
+
+      // Desa en la finestra.
+      total= now-_ft.t0;
+      cols= _ft.cols[_ft.p];
+      cols[COL_CORE]= total;
+      for ( i= 0; i < FRAMETIME_NSTAGES; ++i )
+        {
+          cols[i]= _ft.stages[i];
+          cols[COL_CORE]-= _ft.stages[i];
+        }
+      if ( cols[COL_CORE] < 0 ) cols[COL_CORE]= 0;
+      _ft.total[_ft.p]= total;
+      if ( ++_ft.p == WINDOW ) _ft.p= 0;
+      if ( _ft.N < WINDOW ) ++_ft.N;
+
+      // Sortida.
+      ++_ft.frames;
+      if ( _ft.csv != NULL ) write_csv_row ( total, cols );
+      if ( _ft.hud && _ft.frames%HUD_PERIOD == 0 ) update_hud_lines ();
+
+    }
+
+  // Següent fotograma.
+  _ft.t0= now;
+  for ( i= 0; i < FRAMETIME_NSTAGES; ++i )
+    _ft.stages[i]= 0;
+
+} // end frametime_frame
+
+
+void
+frametime_restart (void)
+{
+
+  int i;
+
+
+  _ft.t0= 0;
+  for ( i= 0; i < FRAMETIME_NSTAGES; ++i )
+    _ft.stages[i]= 0;
+
+} // end frametime_restart
+
+
+const char *
+frametime_hud_line (
+                    const int line
+                    )
+{
+  return _ft.lines[line];
+} // end frametime_hud_line
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/memus.
+ *
+ * adriagipas/memus is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/memus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/memus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  frametime.h - Temps de l'amfitrió en cada fotograma.
+ *
+ *  Mesura, amb el rellotge monòtonic, quant de temps de cada
+ *  fotograma es gasta en cada etapa del frontend. El temps del
+ *  simulador és el que queda: el total menys la resta d'etapes.
+ *
+ *  Opcionalment escriu una fila per fotograma en un fitxer CSV
+ *  (temps en microsegons) i prepara unes línies de text amb els
+ *  percentils de la finestra dels últims fotogrames per al HUD.
+ *
+ */
+
+#ifndef __FRAMETIME_H__
+#define __FRAMETIME_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Nombre de línies de text per al HUD. Cap línia té més de
+ * FRAMETIME_HUD_COLS caràcters.
+ */
+#define FRAMETIME_HUD_LINES 5
+#define FRAMETIME_HUD_COLS 17
+
+typedef enum
+  {
+    FRAMETIME_COPY= 0, // Còpia del framebuffer a la textura.
+    FRAMETIME_SCALER,  // HUD i escalat.
+    FRAMETIME_PRESENT, // Dibuixat i SDL_RenderPresent (inclou vsync).
+    FRAMETIME_SOUND,   // Còpia de mostres al buffer d'àudio.
+    FRAMETIME_SLEEP,   // Espera en el bucle principal.
+    FRAMETIME_NSTAGES
+  } frametime_stage_t;
+
+void
+close_frametime (void);
+
+/* 'hud' indica si es volen calcular les línies per al HUD. 'csv_fn'
+ * pot ser NULL.
+ */
+void
+init_frametime (
+                const bool  hud,
+                const char *csv_fn
+                );
+
+bool
+frametime_hud_enabled (void);
+
+/* Torna l'instant actual, o 0 si no està activat. */
+int64_t
+frametime_begin (void);
+
+/* Afegeix a l'etapa 'stage' el temps transcorregut des de 't0'
+ * (tornat per frametime_begin).
+ */
+void
+frametime_end (
+               const frametime_stage_t stage,
+               const int64_t           t0
+               );
+
+/* Acaba el fotograma actual. S'ha de cridar una vegada per
+ * fotograma, després de presentar-lo.
+ */
+void
+frametime_frame (void);
+
+/* Descarta el fotograma actual. S'ha de cridar quan el simulador
+ * torna a executar-se després d'una pausa (menú, etc.).
+ */
+void
+frametime_restart (void);
+
+/* Línia 'line' del HUD. */
+const char *
+frametime_hud_line (
+                    const int line
+                    );
+
+#endif /* __FRAMETIME_H__ */
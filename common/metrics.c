@@ -0,0 +1,499 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/memus.
+ *
+ * adriagipas/memus is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/memus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/memus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  metrics.c - Implementació de 'metrics.h'.
+ *
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <glib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "error.h"
+#include "metrics.h"
+
+
+
+
+/**********/
+/* MACROS */
+/**********/
+
+// Cada quantes iteracions del bucle es mira el socket.
+#define POLL_PERIOD 64
+
+// Iteracions que s'espera la petició abans de respondre en text.
+#define REQ_TIMEOUT 4
+
+#define REQ_SIZE 512
+
+// Interval per a calcular la velocitat.
+#define SPEED_INTERVAL 1000000
+
+// Fotogrames més llargs es consideren pauses.
+#define MAX_FRAME 1000000
+
+#define NBUCKETS 8
+
+
+
+
+/*************/
+/* CONSTANTS */
+/*************/
+
+// Límits superiors (microsegons) de l'histograma del temps per
+// fotograma. L'últim és +Inf.
+static const gint64 BUCKETS[NBUCKETS-1]=
+  {5000,10000,16667,20000,33333,50000,100000};
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+static struct
+{
+
+  bool           enabled;
+  gchar         *path;
+  gchar         *system;
+  int            fd;
+  gint64         t_start;
+  int            poll_counter;
+
+  // Client esperant resposta.
+  int            client;
+  int            client_wait;
+  char           req[REQ_SIZE];
+  size_t         req_size;
+
+  // Velocitat.
+  gint64         emulated;
+  gint64         speed_t0;
+  gint64         speed_emu;
+  double         speed;
+  unsigned long  lag;
+  bool           in_lag;
+
+  // Fotogrames.
+  gint64         last_frame;
+  unsigned long  frames;
+  unsigned long  buckets[NBUCKETS];
+  gint64         frame_sum;
+  unsigned long  frame_count;
+
+  // Àudio i desat.
+  unsigned long  audio_dropped;
+  gint           audio_underruns;
+  unsigned long  save_flushes;
+
+} _m;
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static long
+get_rss (void)
+{
+
+  FILE *f;
+  long size,rss;
+
+
+  f= fopen ( "/proc/self/statm", "r" );
+  if ( f == NULL ) return -1;
+  if ( fscanf ( f, "%ld %ld", &size, &rss ) != 2 ) rss= -1;
+  fclose ( f );
+
+  return rss == -1 ? -1 : rss*sysconf ( _SC_PAGESIZE );
+
+} // end get_rss
+
+
+static void
+print_counter (
+               GString     *buf,
+               const char  *name,
+               const char  *help,
+               const double val
+               )
+{
+
+  g_string_append_printf ( buf, "# HELP %s %s\n", name, help );
+  g_string_append_printf ( buf, "# TYPE %s counter\n", name );
+  g_string_append_printf ( buf, "%s{system=\"%s\"} %.12g\n",
+                           name, _m.system, val );
+
+} // end print_counter
+
+
+static void
+print_gauge (
+             GString     *buf,
+             const char  *name,
+             const char  *help,
+             const double val
+             )
+{
+
+  g_string_append_printf ( buf, "# HELP %s %s\n", name, help );
+  g_string_append_printf ( buf, "# TYPE %s gauge\n", name );
+  g_string_append_printf ( buf, "%s{system=\"%s\"} %.12g\n",
+                           name, _m.system, val );
+
+} // end print_gauge
+
+
+static GString *
+build_page (void)
+{
+
+  GString *buf;
+  unsigned long acc;
+  int i;
+
+
+  buf= g_string_new ( NULL );
+  print_gauge ( buf, "memus_uptime_seconds",
+                "Temps des que es va iniciar el simulador.",
+                (g_get_monotonic_time ()-_m.t_start)/1e6 );
+  print_gauge ( buf, "memus_speed_ratio",
+                "Temps emulat entre temps real en l'últim segon.",
+                _m.speed );
+  print_counter ( buf, "memus_emulated_seconds_total",
+                  "Temps emulat.", _m.emulated/1e6 );
+  print_counter ( buf, "memus_lag_events_total",
+                  "Vegades que el simulador ha començat a anar tan endarrerit"
+                  " que no ha pogut recuperar el retard.",
+                  (double) _m.lag );
+  print_counter ( buf, "memus_frames_total",
+                  "Fotogrames presentats.", (double) _m.frames );
+
+  // Histograma.
+  g_string_append ( buf, "# HELP memus_frame_seconds Temps entre"
+                    " fotogrames presentats.\n" );
+  g_string_append ( buf, "# TYPE memus_frame_seconds histogram\n" );
+  for ( i= 0, acc= 0; i < NBUCKETS; ++i )
+    {
+      acc+= _m.buckets[i];
+      if ( i < NBUCKETS-1 )
+        g_string_append_printf ( buf, "memus_frame_seconds_bucket"
+                                 "{system=\"%s\",le=\"%g\"} %lu\n",
+                                 _m.system, BUCKETS[i]/1e6, acc );
+      else
+        g_string_append_printf ( buf, "memus_frame_seconds_bucket"
+                                 "{system=\"%s\",le=\"+Inf\"} %lu\n",
+                                 _m.system, acc );
+    }
+  g_string_append_printf ( buf, "memus_frame_seconds_sum{system=\"%s\"}"
+                           " %.12g\n", _m.system, _m.frame_sum/1e6 );
+  g_string_append_printf ( buf, "memus_frame_seconds_count{system=\"%s\"}"
+                           " %lu\n", _m.system, _m.frame_count );
+
+  print_counter ( buf, "memus_audio_dropped_samples_total",
+                  "Mostres d'àudio descartades per falta d'espai.",
+                  (double) _m.audio_dropped );
+  print_counter ( buf, "memus_audio_underruns_total",
+                  "Vegades que el dispositiu d'àudio s'ha quedat sense"
+                  " mostres.",
+                  (double) g_atomic_int_get ( &_m.audio_underruns ) );
+  print_counter ( buf, "memus_save_flushes_total",
+                  "Vegades que s'han desat dades persistents durant"
+                  " l'execució.",
+                  (double) _m.save_flushes );
+  print_gauge ( buf, "memus_resident_memory_bytes",
+                "Memòria resident del procés.", (double) get_rss () );
+
+  return buf;
+
+} // end build_page
+
+
+static void
+reply (
+       const bool http
+       )
+{
+
+  GString *page;
+  gchar *header;
+  const char *p;
+  size_t n;
+  ssize_t ret;
+
+
+  page= build_page ();
+  if ( http )
+    {
+      header= g_strdup_printf ( "HTTP/1.0 200 OK\r\n"
+                                "Content-Type: text/plain; version=0.0.4\r\n"
+                                "Content-Length: %lu\r\n"
+                                "\r\n", (unsigned long) page->len );
+      g_string_prepend ( page, header );
+      g_free ( header );
+    }
+  for ( p= page->str, n= page->len; n > 0; p+= ret, n-= (size_t) ret )
+    {
+      ret= send ( _m.client, p, n, MSG_NOSIGNAL );
+      if ( ret == -1 )
+        {
+          if ( errno == EINTR ) { ret= 0; continue; }
+          break;
+        }
+    }
+  g_string_free ( page, TRUE );
+  close ( _m.client );
+  _m.client= -1;
+
+} // end reply
+
+
+static void
+poll_client (void)
+{
+
+  ssize_t ret;
+  bool http;
+
+
+  // Llig el que haja arribat de la petició.
+  ret= recv ( _m.client, _m.req+_m.req_size, REQ_SIZE-1-_m.req_size,
+              MSG_DONTWAIT );
+  if ( ret == 0 || (ret == -1 && errno != EAGAIN && errno != EWOULDBLOCK) )
+    {
+      close ( _m.client );
+      _m.client= -1;
+      return;
+    }
+  if ( ret > 0 ) _m.req_size+= (size_t) ret;
+  _m.req[_m.req_size]= '\0';
+
+  // Respon quan la petició està completa o s'ha esperat prou.
+  http= strncmp ( _m.req, "GET ", 4 ) == 0;
+  if ( (http && strstr ( _m.req, "\r\n\r\n" ) != NULL) ||
+       _m.req_size == REQ_SIZE-1 ||
+       ++_m.client_wait >= REQ_TIMEOUT )
+    reply ( http );
+
+} // end poll_client
+
+
+static void
+poll_socket (void)
+{
+
+  if ( _m.client == -1 )
+    {
+      _m.client= accept ( _m.fd, NULL, NULL );
+      if ( _m.client == -1 ) return;
+      _m.client_wait= 0;
+      _m.req_size= 0;
+    }
+  poll_client ();
+
+} // end poll_socket
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+void
+close_metrics (void)
+{
+
+  if ( !_m.enabled ) return;
+  if ( _m.client != -1 ) close ( _m.client );
+  close ( _m.fd );
+  unlink ( _m.path );
+  g_free ( _m.path );
+  g_free ( _m.system );
+  _m.enabled= false;
+
+} // end close_metrics
+
+
+void
+init_metrics (
+              const char *path,
+              const char *system
+              )
+{
+
+  struct sockaddr_un addr;
+  struct stat st;
+  int i;
+
+
+  // Adreça.
+  if ( strlen ( path ) >= sizeof(addr.sun_path) )
+    error ( "el nom del socket '%s' és massa llarg", path );
+  memset ( &addr, 0, sizeof(addr) );
+  addr.sun_family= AF_UNIX;
+  strcpy ( addr.sun_path, path );
+
+  // Esborra un socket vell.
+  if ( stat ( path, &st ) == 0 )
+    {
+      if ( !S_ISSOCK ( st.st_mode ) )
+        error ( "'%s' existeix i no és un socket", path );
+      unlink ( path );
+    }
+
+  // Crea el socket.
+  _m.fd= socket ( AF_UNIX, SOCK_STREAM, 0 );
+  if ( _m.fd == -1 )
+    error ( "no s'ha pogut crear el socket: %s", strerror ( errno ) );
+  if ( bind ( _m.fd, (struct sockaddr *) &addr, sizeof(addr) ) == -1 ||
+       listen ( _m.fd, 4 ) == -1 ||
+       fcntl ( _m.fd, F_SETFL, O_NONBLOCK ) == -1 )
+    error ( "no s'ha pogut escoltar en '%s': %s", path, strerror ( errno ) );
+
+  // Estat.
+  _m.enabled= true;
+  _m.path= g_strdup ( path );
+  _m.system= g_strdup ( system );
+  _m.t_start= g_get_monotonic_time ();
+  _m.poll_counter= 0;
+  _m.client= -1;
+  _m.emulated= 0;
+  _m.speed_t0= _m.t_start;
+  _m.speed_emu= 0;
+  _m.speed= 0.0;
+  _m.lag= 0;
+  _m.in_lag= false;
+  _m.last_frame= 0;
+  _m.frames= 0;
+  for ( i= 0; i < NBUCKETS; ++i ) _m.buckets[i]= 0;
+  _m.frame_sum= 0;
+  _m.frame_count= 0;
+  _m.audio_dropped= 0;
+  g_atomic_int_set ( &_m.audio_underruns, 0 );
+  _m.save_flushes= 0;
+
+} // end init_metrics
+
+
+void
+metrics_loop (
+              const int64_t usecs,
+              const bool    lag
+              )
+{
+
+  gint64 now;
+
+
+  if ( !_m.enabled ) return;
+
+  // Velocitat.
+  _m.emulated+= usecs;
+  _m.speed_emu+= usecs;
+  if ( lag && !_m.in_lag ) ++_m.lag;
+  _m.in_lag= lag;
+  if ( ++_m.poll_counter < POLL_PERIOD ) return;
+  _m.poll_counter= 0;
+  now= g_get_monotonic_time ();
+  if ( now-_m.speed_t0 >= SPEED_INTERVAL )
+    {
+      _m.speed= _m.speed_emu / (double) (now-_m.speed_t0);
+      _m.speed_t0= now;
+      _m.speed_emu= 0;
+    }
+
+  // Socket.
+  poll_socket ();
+
+} // end metrics_loop
+
+
+void
+metrics_frame (void)
+{
+
+  gint64 now,t;
+  int i;
+
+
+  if ( !_m.enabled ) return;
+
+  ++_m.frames;
+  now= g_get_monotonic_time ();
+  if ( _m.last_frame != 0 && (t= now-_m.last_frame) < MAX_FRAME )
+    {
+      for ( i= 0; i < NBUCKETS-1 && t > BUCKETS[i]; ++i );
+      ++_m.buckets[i];
+      _m.frame_sum+= t;
+      ++_m.frame_count;
+    }
+  _m.last_frame= now;
+
+} // end metrics_frame
+
+
+void
+metrics_audio_dropped (
+                       const unsigned long nsamples
+                       )
+{
+
+  if ( !_m.enabled ) return;
+  _m.audio_dropped+= nsamples;
+
+} // end metrics_audio_dropped
+
+
+void
+metrics_audio_underrun (void)
+{
+
+  if ( !_m.enabled ) return;
+  g_atomic_int_inc ( &_m.audio_underruns );
+
+} // end metrics_audio_underrun
+
+
+void
+metrics_save_flush (void)
+{
+
+  if ( !_m.enabled ) return;
+  ++_m.save_flushes;
+
+} // end metrics_save_flush
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/memus.
+ *
+ * adriagipas/memus is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/memus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/memus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  metrics.h - Mètriques del simulador en format de text de
+ *              Prometheus.
+ *
+ *  Escolta en un socket UNIX. A cada connexió li torna la pàgina de
+ *  mètriques i la tanca. Si la connexió envia una petició HTTP
+ *  (p.e. 'curl --unix-socket SOCKET http://localhost/metrics') la
+ *  resposta porta capçalera HTTP, si no sols el text.
+ *
+ *  No hi ha fils: les connexions s'atenen des de metrics_loop, per
+ *  tant mentre el simulador està en el menú no es responen (queden
+ *  esperant).
+ *
+ */
+
+#ifndef __METRICS_H__
+#define __METRICS_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+void
+close_metrics (void);
+
+/* Crea el socket 'path'. 'system' identifica el simulador. */
+void
+init_metrics (
+              const char *path,
+              const char *system
+              );
+
+/* Cridar en cada iteració del bucle principal. 'usecs' és el temps
+ * emulat en la iteració i 'lag' indica que el simulador va tan
+ * endarrerit que s'ha descartat part del retard acumulat. Sols es
+ * compta un esdeveniment de retard quan 'lag' passa de fals a cert,
+ * no per cada iteració que continua endarrerida.
+ */
+void
+metrics_loop (
+              const int64_t usecs,
+              const bool    lag
+              );
+
+/* Cridar una vegada per fotograma presentat. */
+void
+metrics_frame (void);
+
+void
+metrics_audio_dropped (
+                       const unsigned long nsamples
+                       );
+
+/* Es pot cridar des del fil d'àudio. */
+void
+metrics_audio_underrun (void);
+
+/* S'han desat en disc dades persistents mentre el simulador
+ * s'executa. De moment sols ho fa memups, quan es lleva o es canvia
+ * una memory card. La SRAM i l'EEPROM de la resta de simuladors sols
+ * es desen en eixir, quan ja no es poden consultar les mètriques, i
+ * no es compten.
+ */
+void
+metrics_save_flush (void);
+
+#endif /* __METRICS_H__ */
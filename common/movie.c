@@ -0,0 +1,622 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/memus.
+ *
+ * adriagipas/memus is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/memus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/memus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  movie.c - Implementació de 'movie.h'.
+ *
+ */
+
+
+#include <errno.h>
+#include <glib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+#include "movie.h"
+
+
+
+
+/**********/
+/* MACROS */
+/**********/
+
+#define MAGIC "MEMUMOV"
+// Versió 2: la configuració es serialitza camp a camp.
+#define VERSION 2
+
+
+
+
+/*********/
+/* TIPUS */
+/*********/
+
+enum {
+  MODE_NONE= 0,
+  MODE_RECORD_WAIT,
+  MODE_RECORD,
+  MODE_REPLAY
+};
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+static struct
+{
+
+  int       mode;
+  bool      verbose;
+  gchar    *fn;
+  FILE     *f;
+  uint64_t  nsamples;
+
+  // Repetició actual.
+  uint32_t  val;
+  uint64_t  count;
+  bool      end;
+
+  // Configuració i estat inicial (sols reproduint).
+  uint8_t  *config;
+  size_t    config_size;
+  uint8_t  *state;
+  size_t    state_size;
+
+} _movie;
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static void
+write_bytes (
+             const void   *data,
+             const size_t  size
+             )
+{
+
+  if ( size > 0 && fwrite ( data, size, 1, _movie.f ) != 1 )
+    error ( "no s'ha pogut escriure en '%s': %s",
+            _movie.fn, strerror ( errno ) );
+
+} // end write_bytes
+
+
+static void
+write_uint (
+            uint64_t  val,
+            const int nbytes
+            )
+{
+
+  uint8_t buf[8];
+  int i;
+
+
+  for ( i= 0; i < nbytes; ++i, val>>= 8 )
+    buf[i]= (uint8_t) (val&0xFF);
+  write_bytes ( buf, nbytes );
+
+} // end write_uint
+
+
+static void
+write_leb128 (
+              uint64_t val
+              )
+{
+
+  uint8_t byte;
+
+
+  do {
+    byte= (uint8_t) (val&0x7F);
+    val>>= 7;
+    if ( val != 0 ) byte|= 0x80;
+    write_bytes ( &byte, 1 );
+  } while ( val != 0 );
+
+} // end write_leb128
+
+
+static void
+flush_run (void)
+{
+
+  if ( _movie.count == 0 ) return;
+  write_leb128 ( _movie.count );
+  write_leb128 ( _movie.val );
+  _movie.count= 0;
+
+} // end flush_run
+
+
+static bool
+read_uint (
+           uint64_t  *val,
+           const int  nbytes
+           )
+{
+
+  uint8_t buf[8];
+  int i;
+
+
+  if ( fread ( buf, nbytes, 1, _movie.f ) != 1 ) return false;
+  *val= 0;
+  for ( i= nbytes-1; i >= 0; --i )
+    *val= ((*val)<<8) | buf[i];
+
+  return true;
+
+} // end read_uint
+
+
+static bool
+read_leb128 (
+             uint64_t *val
+             )
+{
+
+  int c, shift;
+
+
+  *val= 0;
+  shift= 0;
+  do {
+    c= fgetc ( _movie.f );
+    if ( c == EOF || shift > 63 ) return false;
+    *val|= ((uint64_t) (c&0x7F))<<shift;
+    shift+= 7;
+  } while ( c&0x80 );
+
+  return true;
+
+} // end read_leb128
+
+
+// Llig la següent repetició. Si no en queden marca el final.
+static void
+next_run (void)
+{
+
+  uint64_t count, val;
+
+
+  if ( !read_leb128 ( &count ) || count == 0 || !read_leb128 ( &val ) )
+    {
+      _movie.end= true;
+      _movie.count= 0;
+      if ( _movie.verbose )
+        fprintf ( stderr, "Pel·lícula '%s' acabada (%lu mostres)\n",
+                  _movie.fn, (unsigned long) _movie.nsamples );
+    }
+  else
+    {
+      _movie.count= count;
+      _movie.val= (uint32_t) val;
+    }
+
+} // end next_run
+
+
+// Llig un bloc de bytes amb la grandària codificada en 'nbytes'.
+static bool
+read_blob (
+           uint8_t   **data,
+           size_t     *size,
+           const int   nbytes
+           )
+{
+
+  uint64_t tmp;
+
+
+  *data= NULL;
+  if ( !read_uint ( &tmp, nbytes ) ) return false;
+  *size= (size_t) tmp;
+  if ( tmp > 0 )
+    {
+      *data= g_new ( uint8_t, tmp );
+      if ( fread ( *data, tmp, 1, _movie.f ) != 1 ) return false;
+    }
+
+  return true;
+
+} // end read_blob
+
+
+// Llig una cadena amb la longitut codificada en 'nbytes'.
+static gchar *
+read_string (
+             const int nbytes
+             )
+{
+
+  uint64_t len;
+  gchar *ret;
+
+
+  if ( !read_uint ( &len, nbytes ) ) return NULL;
+  ret= g_new ( gchar, len+1 );
+  if ( len > 0 && fread ( ret, len, 1, _movie.f ) != 1 )
+    {
+      g_free ( ret );
+      return NULL;
+    }
+  ret[len]= '\0';
+
+  return ret;
+
+} // end read_string
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+void
+close_movie (void)
+{
+
+  switch ( _movie.mode )
+    {
+    case MODE_RECORD:
+      flush_run ();
+      write_leb128 ( 0 );
+      if ( fclose ( _movie.f ) != 0 )
+        error ( "no s'ha pogut acabar d'escriure '%s': %s",
+                _movie.fn, strerror ( errno ) );
+      if ( _movie.verbose )
+        fprintf ( stderr, "Pel·lícula desada en '%s' (%lu mostres)\n",
+                  _movie.fn, (unsigned long) _movie.nsamples );
+      break;
+    case MODE_RECORD_WAIT:
+      fclose ( _movie.f );
+      remove ( _movie.fn );
+      break;
+    case MODE_REPLAY:
+      fclose ( _movie.f );
+      g_free ( _movie.config );
+      g_free ( _movie.state );
+      break;
+    case MODE_NONE:
+    default:
+      return;
+    }
+  g_free ( _movie.fn );
+  _movie.mode= MODE_NONE;
+
+} // end close_movie
+
+
+void
+movie_stop_record (
+                   const char *reason
+                   )
+{
+
+  if ( _movie.mode != MODE_RECORD ) return;
+  warning ( "s'ha aturat la gravació de la pel·lícula: %s", reason );
+  close_movie ();
+  
+} // end movie_stop_record
+
+
+void
+init_movie_record (
+                   const char *fn,
+                   const char *system,
+                   const char *id,
+                   const bool  verbose
+                   )
+{
+
+  uint8_t version;
+
+
+  _movie.fn= g_strdup ( fn );
+  _movie.verbose= verbose;
+  _movie.nsamples= 0;
+  _movie.count= 0;
+  _movie.end= false;
+  _movie.config= NULL;
+  _movie.state= NULL;
+  _movie.f= fopen ( fn, "wb" );
+  if ( _movie.f == NULL )
+    error ( "no s'ha pogut crear '%s': %s", fn, strerror ( errno ) );
+
+  // Capçalera.
+  version= VERSION;
+  write_bytes ( MAGIC, strlen ( MAGIC ) );
+  write_bytes ( &version, 1 );
+  write_uint ( strlen ( system ), 1 );
+  write_bytes ( system, strlen ( system ) );
+  write_uint ( strlen ( id ), 2 );
+  write_bytes ( id, strlen ( id ) );
+  _movie.mode= MODE_RECORD_WAIT;
+
+} // end init_movie_record
+
+
+bool
+init_movie_replay (
+                   const char *fn,
+                   const char *system,
+                   const char *id,
+                   const bool  verbose
+                   )
+{
+
+  char magic[sizeof(MAGIC)];
+  uint8_t version;
+  gchar *msystem, *mid;
+
+
+  _movie.fn= g_strdup ( fn );
+  _movie.verbose= verbose;
+  _movie.nsamples= 0;
+  _movie.count= 0;
+  _movie.end= false;
+  _movie.config= NULL;
+  _movie.state= NULL;
+  msystem= mid= NULL;
+  _movie.f= fopen ( fn, "rb" );
+  if ( _movie.f == NULL )
+    {
+      warning ( "no s'ha pogut obrir '%s': %s", fn, strerror ( errno ) );
+      g_free ( _movie.fn );
+      return false;
+    }
+
+  // Capçalera.
+  if ( fread ( magic, strlen ( MAGIC ), 1, _movie.f ) != 1 ||
+       strncmp ( magic, MAGIC, strlen ( MAGIC ) ) != 0 ||
+       fread ( &version, 1, 1, _movie.f ) != 1 ||
+       version != VERSION )
+    goto wrong_format;
+  msystem= read_string ( 1 );
+  if ( msystem == NULL ) goto wrong_format;
+  if ( strcmp ( msystem, system ) != 0 )
+    {
+      warning ( "'%s' és una pel·lícula de %s, no de %s", fn, msystem, system );
+      goto error;
+    }
+  mid= read_string ( 2 );
+  if ( mid == NULL ) goto wrong_format;
+  if ( id != NULL && strcmp ( mid, id ) != 0 )
+    warning ( "'%s' es va gravar amb '%s'", fn, mid );
+
+  // Configuració i estat inicial.
+  if ( !read_blob ( &_movie.config, &_movie.config_size, 2 ) ||
+       !read_blob ( &_movie.state, &_movie.state_size, 4 ) )
+    goto wrong_format;
+
+  // Prepara.
+  g_free ( msystem );
+  g_free ( mid );
+  _movie.mode= MODE_REPLAY;
+  next_run ();
+  if ( verbose )
+    fprintf ( stderr, "Reproduint la pel·lícula '%s'\n", fn );
+
+  return true;
+
+ wrong_format:
+  warning ( "'%s' no és una pel·lícula vàlida", fn );
+ error:
+  g_free ( msystem );
+  g_free ( mid );
+  g_free ( _movie.config );
+  g_free ( _movie.state );
+  _movie.config= NULL;
+  _movie.state= NULL;
+  fclose ( _movie.f );
+  g_free ( _movie.fn );
+  return false;
+
+} // end init_movie_replay
+
+
+bool
+movie_record_waiting (void)
+{
+  return _movie.mode == MODE_RECORD_WAIT;
+} // end movie_record_waiting
+
+
+bool
+movie_is_recording (void)
+{
+  return _movie.mode == MODE_RECORD;
+} // end movie_is_recording
+
+
+bool
+movie_is_replaying (void)
+{
+  return _movie.mode == MODE_REPLAY;
+} // end movie_is_replaying
+
+
+bool
+movie_end (void)
+{
+  return _movie.mode == MODE_REPLAY && _movie.end;
+} // end movie_end
+
+
+uint64_t
+movie_get_nsamples (void)
+{
+  return _movie.nsamples;
+} // end movie_get_nsamples
+
+
+uint32_t
+movie_sample (
+              const uint32_t val
+              )
+{
+
+  uint32_t ret;
+
+
+  switch ( _movie.mode )
+    {
+    case MODE_RECORD:
+      if ( _movie.count > 0 && val != _movie.val ) flush_run ();
+      _movie.val= val;
+      ++_movie.count;
+      ++_movie.nsamples;
+      return val;
+    case MODE_REPLAY:
+      if ( _movie.end ) return 0;
+      ret= _movie.val;
+      ++_movie.nsamples;
+      if ( --_movie.count == 0 ) next_run ();
+      return ret;
+    default:
+      return val;
+    }
+
+} // end movie_sample
+
+
+FILE *
+movie_state_open_write (void)
+{
+
+  FILE *f;
+
+
+  f= tmpfile ();
+  if ( f == NULL )
+    warning ( "no s'ha pogut crear un fitxer temporal per a l'estat"
+              " inicial: %s", strerror ( errno ) );
+
+  return f;
+
+} // end movie_state_open_write
+
+
+bool
+movie_start_record (
+                    const void   *config,
+                    const size_t  config_size,
+                    FILE         *state
+                    )
+{
+
+  long size;
+  uint8_t *buf;
+
+
+  if ( _movie.mode != MODE_RECORD_WAIT )
+    {
+      fclose ( state );
+      return false;
+    }
+
+  // Llig l'estat.
+  buf= NULL;
+  if ( fseek ( state, 0, SEEK_END ) == -1 ) goto error;
+  size= ftell ( state );
+  if ( size == -1 ) goto error;
+  rewind ( state );
+  buf= g_new ( uint8_t, size>0 ? size : 1 );
+  if ( size > 0 && fread ( buf, size, 1, state ) != 1 ) goto error;
+  fclose ( state );
+
+  // Escriu i comença a gravar.
+  write_uint ( config_size, 2 );
+  write_bytes ( config, config_size );
+  write_uint ( (uint64_t) size, 4 );
+  write_bytes ( buf, size );
+  g_free ( buf );
+  _movie.mode= MODE_RECORD;
+  if ( _movie.verbose )
+    fprintf ( stderr, "Gravant la pel·lícula '%s'\n", _movie.fn );
+
+  return true;
+
+ error:
+  warning ( "no s'ha pogut llegir l'estat inicial: %s", strerror ( errno ) );
+  g_free ( buf );
+  fclose ( state );
+  return false;
+
+} // end movie_start_record
+
+
+const void *
+movie_get_config (
+                  const size_t size
+                  )
+{
+
+  if ( _movie.mode != MODE_REPLAY || _movie.config == NULL ||
+       _movie.config_size != size )
+    return NULL;
+
+  return _movie.config;
+
+} // end movie_get_config
+
+
+FILE *
+movie_state_open_read (void)
+{
+
+  FILE *f;
+
+
+  if ( _movie.mode != MODE_REPLAY || _movie.state == NULL ) return NULL;
+  f= tmpfile ();
+  if ( f == NULL )
+    {
+      warning ( "no s'ha pogut crear un fitxer temporal per a l'estat"
+                " inicial: %s", strerror ( errno ) );
+      return NULL;
+    }
+  if ( fwrite ( _movie.state, _movie.state_size, 1, f ) != 1 )
+    {
+      warning ( "no s'ha pogut escriure l'estat inicial: %s",
+                strerror ( errno ) );
+      fclose ( f );
+      return NULL;
+    }
+  rewind ( f );
+
+  return f;
+
+} // end movie_state_open_read
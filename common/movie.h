@@ -0,0 +1,144 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/memus.
+ *
+ * adriagipas/memus is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/memus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/memus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  movie.h - Gravació i reproducció de l'entrada del simulador.
+ *
+ *  Una pel·lícula conté un estat inicial del simulador i la
+ *  seqüència de valors que el simulador ha llegit dels controladors
+ *  (i de la resta d'entrades no deterministes) en l'ordre en què els
+ *  ha llegit. Si el simulador és determinista, reproduir la
+ *  pel·lícula des del mateix estat inicial dona exactament la mateixa
+ *  execució.
+ *
+ *  Format (enters en little endian):
+ *
+ *    "MEMUMOV" + versió (1 byte)
+ *    sistema: longitut (1 byte) + caràcters
+ *    identificador: longitut (2 bytes) + caràcters
+ *    configuració: grandària (2 bytes) + bytes
+ *    estat inicial: grandària (4 bytes) + bytes
+ *    mostres: parelles (repeticions,valor) codificades en LEB128. Una
+ *             parella amb 0 repeticions indica el final.
+ *
+ */
+
+#ifndef __MOVIE_H__
+#define __MOVIE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+void
+close_movie (void);
+
+/* Si s'està gravant, avisa del motiu 'reason' i acaba la gravació
+ * (la pel·lícula es queda amb el que s'ha gravat fins ara). Els
+ * simuladors la criden quan passa alguna cosa que la pel·lícula no
+ * pot reproduir (canvi de disc, reinicialització, etc.).
+ */
+void
+movie_stop_record (
+                   const char *reason
+                   );
+
+/* Prepara la gravació en 'fn'. 'system' identifica el simulador i
+ * 'id' la ROM o disc. La gravació no comença fins que es crida a
+ * movie_start_record.
+ */
+void
+init_movie_record (
+                   const char *fn,
+                   const char *system,
+                   const char *id,
+                   const bool  verbose
+                   );
+
+/* Obri per a reproduir la pel·lícula 'fn'. Torna false si no es pot
+ * llegir o no és del sistema 'system'. Si 'id' no és NULL i no
+ * coincideix sols avisa.
+ */
+bool
+init_movie_replay (
+                   const char *fn,
+                   const char *system,
+                   const char *id,
+                   const bool  verbose
+                   );
+
+/* Cert si s'ha preparat una gravació que encara no ha començat. */
+bool
+movie_record_waiting (void);
+
+bool
+movie_is_recording (void);
+
+bool
+movie_is_replaying (void);
+
+/* Cert quan s'està reproduint i ja no queden mostres. */
+bool
+movie_end (void);
+
+/* Nombre de mostres gravades o reproduïdes fins ara. */
+uint64_t
+movie_get_nsamples (void);
+
+/* Gravant: guarda 'val' i el torna. Reproduint: torna el següent
+ * valor gravat (0 si s'ha acabat). En altre cas torna 'val'.
+ */
+uint32_t
+movie_sample (
+              const uint32_t val
+              );
+
+/* Fitxer temporal on el simulador ha de desar l'estat inicial. Pot
+ * tornar NULL.
+ */
+FILE *
+movie_state_open_write (void);
+
+/* Comença a gravar. 'config' són els paràmetres del simulador que no
+ * formen part de l'estat (model, dispositius...) i 'state' el fitxer
+ * tornat per movie_state_open_write amb l'estat inicial ja desat
+ * (es tanca). Torna false si no s'ha pogut.
+ */
+bool
+movie_start_record (
+                    const void   *config,
+                    const size_t  config_size,
+                    FILE         *state
+                    );
+
+/* Configuració de la pel·lícula que s'està reproduint. Torna NULL si
+ * no té o la grandària no és 'size'.
+ */
+const void *
+movie_get_config (
+                  const size_t size
+                  );
+
+/* Fitxer temporal amb l'estat inicial de la pel·lícula que s'està
+ * reproduint. Torna NULL si la pel·lícula no té estat.
+ */
+FILE *
+movie_state_open_read (void);
+
+#endif /* __MOVIE_H__ */
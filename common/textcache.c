@@ -0,0 +1,250 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/memus.
+ *
+ * adriagipas/memus is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/memus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/memus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  textcache.c - Implementació de 'textcache.h'.
+ *
+ */
+
+
+#include <glib.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "textcache.h"
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static void
+add_run (
+         textcache_entry_t *e,
+         const int          row,
+         const int          beg,
+         const int          len
+         )
+{
+
+  if ( e->nruns == e->runs_size )
+    {
+      e->runs_size*= 2;
+      e->runs= g_renew ( textcache_run_t, e->runs, e->runs_size );
+    }
+  e->runs[e->nruns].row= (short) row;
+  e->runs[e->nruns].beg= (short) beg;
+  e->runs[e->nruns].len= (short) len;
+  ++(e->nruns);
+
+} /* end add_run */
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+void
+textcache_init (
+                textcache_t *tc
+                )
+{
+
+  int i;
+  textcache_entry_t *e;
+
+
+  tc->counter= 0;
+  for ( i= 0; i < TEXTCACHE_SIZE; ++i )
+    {
+      e= &(tc->v[i]);
+      e->text= NULL;
+      e->last_use= 0;
+      e->pix= NULL;
+      e->mask= NULL;
+      e->pix_size= 0;
+      e->runs_size= 8;
+      e->runs= g_new ( textcache_run_t, e->runs_size );
+      e->nruns= 0;
+    }
+
+} /* end textcache_init */
+
+
+void
+textcache_free (
+                textcache_t *tc
+                )
+{
+
+  int i;
+  textcache_entry_t *e;
+
+
+  for ( i= 0; i < TEXTCACHE_SIZE; ++i )
+    {
+      e= &(tc->v[i]);
+      g_free ( e->text );
+      g_free ( e->pix );
+      g_free ( e->mask );
+      g_free ( e->runs );
+    }
+
+} /* end textcache_free */
+
+
+textcache_entry_t *
+textcache_lookup (
+                  textcache_t *tc,
+                  const char  *text,
+                  const int    colors[3],
+                  const int    flags
+                  )
+{
+
+  int i;
+  textcache_entry_t *e;
+
+
+  for ( i= 0; i < TEXTCACHE_SIZE; ++i )
+    {
+      e= &(tc->v[i]);
+      if ( e->text != NULL &&
+           e->flags == flags &&
+           e->colors[0] == colors[0] &&
+           e->colors[1] == colors[1] &&
+           e->colors[2] == colors[2] &&
+           strcmp ( e->text, text ) == 0 )
+        {
+          e->last_use= ++(tc->counter);
+          return e;
+        }
+    }
+
+  return NULL;
+
+} /* end textcache_lookup */
+
+
+textcache_entry_t *
+textcache_insert (
+                  textcache_t *tc,
+                  const char  *text,
+                  const int    colors[3],
+                  const int    flags,
+                  const int    width,
+                  const int    height
+                  )
+{
+
+  int i, size;
+  textcache_entry_t *e;
+
+
+  if ( strlen ( text ) > TEXTCACHE_MAX_LEN ) return NULL;
+
+  /* Busca la menys usada recentment. */
+  e= &(tc->v[0]);
+  for ( i= 1; i < TEXTCACHE_SIZE && e->text != NULL; ++i )
+    if ( tc->v[i].text == NULL || tc->v[i].last_use < e->last_use )
+      e= &(tc->v[i]);
+
+  /* Inicialitza. */
+  g_free ( e->text );
+  e->text= g_strdup ( text );
+  e->colors[0]= colors[0];
+  e->colors[1]= colors[1];
+  e->colors[2]= colors[2];
+  e->flags= flags;
+  e->nchars= 0;
+  e->last_use= ++(tc->counter);
+  e->width= width;
+  e->height= height;
+  size= width*height;
+  if ( size > e->pix_size )
+    {
+      e->pix= g_renew ( int, e->pix, size );
+      e->mask= g_renew ( unsigned char, e->mask, size );
+      e->pix_size= size;
+    }
+  e->nruns= 0;
+
+  return e;
+
+} /* end textcache_insert */
+
+
+void
+textcache_commit (
+                  textcache_entry_t *e
+                  )
+{
+
+  int r, c, beg;
+  const unsigned char *mask;
+
+
+  e->nruns= 0;
+  mask= e->mask;
+  for ( r= 0; r < e->height; ++r, mask+= e->width )
+    {
+      beg= -1;
+      for ( c= 0; c < e->width; ++c )
+        if ( mask[c] )
+          {
+            if ( beg == -1 ) beg= c;
+          }
+        else if ( beg != -1 )
+          {
+            add_run ( e, r, beg, c-beg );
+            beg= -1;
+          }
+      if ( beg != -1 ) add_run ( e, r, beg, e->width-beg );
+    }
+
+} /* end textcache_commit */
+
+
+void
+textcache_blit (
+                const textcache_entry_t *e,
+                int                     *fb,
+                const int                fb_width,
+                const int                x,
+                const int                y
+                )
+{
+
+  int i;
+  const textcache_run_t *run;
+
+
+  for ( i= 0; i < e->nruns; ++i )
+    {
+      run= &(e->runs[i]);
+      memcpy ( &(fb[(y+run->row)*fb_width + x + run->beg]),
+               &(e->pix[run->row*e->width + run->beg]),
+               sizeof(int)*run->len );
+    }
+
+} /* end textcache_blit */
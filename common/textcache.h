@@ -0,0 +1,129 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/memus.
+ *
+ * adriagipas/memus is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/memus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/memus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  textcache.h - Memòria cau LRU de cadenes ja rasteritzades.
+ *
+ *  Les llibreries de fonts (tiles8b, tiles16b, t8biso i vgafont)
+ *  guarden ací les cadenes que dibuixen, ja convertides i
+ *  rasteritzades amb els seus colors. Redibuixar una cadena que està
+ *  en la memòria cau es redueix a copiar trams de píxels (memcpy).
+ *
+ */
+
+#ifndef __TEXTCACHE_H__
+#define __TEXTCACHE_H__
+
+/* Nombre d'entrades de la memòria cau. */
+#define TEXTCACHE_SIZE 16
+
+/* Les cadenes més llargues no es guarden. */
+#define TEXTCACHE_MAX_LEN 128
+
+/* PRIVAT */
+typedef struct
+{
+
+  short row;
+  short beg;
+  short len;
+
+} textcache_run_t;
+
+typedef struct
+{
+
+  char            *text;       /* NULL indica entrada buida. */
+  int              colors[3];
+  int              flags;
+  int              nchars;     /* Valor lliure per a l'usuari. */
+  unsigned int     last_use;
+  int              width;      /* En píxels. */
+  int              height;     /* En píxels. */
+  int             *pix;        /* width*height */
+  unsigned char   *mask;       /* width*height, 1 indica que s'escriu. */
+  int              pix_size;
+  textcache_run_t *runs;       /* Trams opacs. */
+  int              nruns;
+  int              runs_size;
+
+} textcache_entry_t;
+
+typedef struct
+{
+
+  textcache_entry_t v[TEXTCACHE_SIZE];
+  unsigned int      counter;
+
+} textcache_t;
+
+void
+textcache_init (
+                textcache_t *tc
+                );
+
+/* Sols allibera la memòria interna. */
+void
+textcache_free (
+                textcache_t *tc
+                );
+
+/* Busca una cadena prèviament rasteritzada amb els mateixos colors i
+ * flags. Torna NULL si no està. 'colors' sempre té 3 valors (els que
+ * no s'usen han de ser 0).
+ */
+textcache_entry_t *
+textcache_lookup (
+                  textcache_t *tc,
+                  const char  *text,
+                  const int    colors[3],
+                  const int    flags
+                  );
+
+/* Reserva una entrada (descartant la menys usada recentment) amb un
+ * buffer de width*height píxels. L'usuari ha d'omplir 'pix' i 'mask'
+ * i després cridar a textcache_commit. Torna NULL si la cadena és
+ * massa llarga per a guardar-la.
+ */
+textcache_entry_t *
+textcache_insert (
+                  textcache_t *tc,
+                  const char  *text,
+                  const int    colors[3],
+                  const int    flags,
+                  const int    width,
+                  const int    height
+                  );
+
+/* Calcula els trams opacs a partir de 'mask'. */
+void
+textcache_commit (
+                  textcache_entry_t *e
+                  );
+
+/* Copia l'entrada en el framebuffer. x i y en píxels. */
+void
+textcache_blit (
+                const textcache_entry_t *e,
+                int                     *fb,
+                const int                fb_width,
+                const int                x,
+                const int                y
+                );
+
+#endif /* __TEXTCACHE_H__ */
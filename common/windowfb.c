@@ -33,6 +33,7 @@
 #include <string.h>
 
 #include "error.h"
+#include "frametime.h"
 #include "windowfb.h"
 
 
@@ -506,8 +507,10 @@ windowfb_update (
 
   int r,c,i,pitch;
   uint8_t *buffer;
+  int64_t t0;
   
 
+  t0= frametime_begin ();
   if ( SDL_LockTexture ( _sdl.fb, NULL, (void **) &buffer, &pitch ) != 0 )
     error ( "no s'ha pogut actualitzar la textura: %s", SDL_GetError () );
   for ( r= i= 0; r < _sdl.fbheight; ++r )
@@ -517,7 +520,10 @@ windowfb_update (
       buffer+= pitch;
     }
   SDL_UnlockTexture ( _sdl.fb );
+  frametime_end ( FRAMETIME_COPY, t0 );
+  t0= frametime_begin ();
   draw ();
+  frametime_end ( FRAMETIME_PRESENT, t0 );
   
 } // end windowfb_update
 
@@ -530,8 +536,10 @@ windowfb_update_no_pal (
 
   int r,c,i,pitch;
   uint8_t *buffer;
+  int64_t t0;
   
 
+  t0= frametime_begin ();
   if ( SDL_LockTexture ( _sdl.fb, NULL, (void **) &buffer, &pitch ) != 0 )
     error ( "no s'ha pogut actualitzar la textura: %s", SDL_GetError () );
   for ( r= i= 0; r < _sdl.fbheight; ++r )
@@ -541,7 +549,10 @@ windowfb_update_no_pal (
       buffer+= pitch;
     }
   SDL_UnlockTexture ( _sdl.fb );
+  frametime_end ( FRAMETIME_COPY, t0 );
+  t0= frametime_begin ();
   draw ();
+  frametime_end ( FRAMETIME_PRESENT, t0 );
   
 } // end windowfb_update_no_pal
 
@@ -31,6 +31,7 @@
 #include <string.h>
 
 #include "error.h"
+#include "frametime.h"
 #include "windowtex.h"
 
 
@@ -464,7 +465,14 @@ windowtex_draw_begin (void)
 void
 windowtex_draw_end (void)
 {
+
+  int64_t t0;
+
+
+  t0= frametime_begin ();
   SDL_RenderPresent ( _sdl.renderer );
+  frametime_end ( FRAMETIME_PRESENT, t0 );
+  
 } // end windowtex_draw_end
 
 
@@ -644,6 +652,35 @@ tex_copy_fb (
 } // end tex_copy_fb
 
 
+void
+tex_copy_fb_rows (
+                  tex_t          *tex,
+                  const uint32_t *fb,
+                  const int       w,
+                  const int       row0,
+                  const int       row1
+                  )
+{
+
+  int r,pitch;
+  uint8_t *buffer;
+  SDL_Rect rect;
+  
+  
+  rect.x= 0; rect.y= row0;
+  rect.w= w; rect.h= row1-row0;
+  if ( SDL_LockTexture ( tex->tex, &rect, (void **) &buffer, &pitch ) != 0 )
+    error ( "no s'ha pogut actualitzar la textura: %s", SDL_GetError () );
+  
+  fb+= row0*w;
+  for ( r= row0; r < row1; ++r, fb+= w, buffer+= pitch )
+    memcpy ( buffer, fb, w*sizeof(uint32_t) );
+  
+  SDL_UnlockTexture ( tex->tex );
+  
+} // end tex_copy_fb_rows
+
+
 void
 tex_copy_fb_pal (
                  tex_t          *tex,
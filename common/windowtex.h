@@ -173,6 +173,17 @@ tex_copy_fb (
              const int       h
              );
 
+// Com tex_copy_fb però sols actualitza les files [row0,row1) de la
+// textura. 'fb' és el framebuffer sencer d'amplària 'w'.
+void
+tex_copy_fb_rows (
+                  tex_t          *tex,
+                  const uint32_t *fb,
+                  const int       w,
+                  const int       row0,
+                  const int       row1
+                  );
+
 // Utilitza una paletta de colors.
 // NOTA!! No fa cap comprovació dels índex.
 void
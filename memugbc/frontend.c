@@ -28,12 +28,17 @@
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "error.h"
+#include "frametime.h"
 #include "frontend.h"
 #include "hud.h"
 #include "menu.h"
+#include "metrics.h"
+#include "movie.h"
 #include "pad.h"
+#include "replay.h"
 #include "rom.h"
 #include "screen.h"
 #include "sound.h"
@@ -221,6 +226,13 @@ load_state (
   FILE *f;
   
   
+  // Carregar un estat trencaria la pel·lícula.
+  if ( movie_is_recording () )
+    {
+      hud_show_msg ( "GRAVANT!" );
+      return;
+    }
+  
   f= state_open_read ( num );
   if ( f == NULL )
     {
@@ -240,6 +252,36 @@ load_state (
 } /* end load_state */
 
 
+// Comença la gravació preparada en main (si n'hi ha) a partir de
+// l'estat actual.
+static void
+start_record (void)
+{
+
+  FILE *f;
+  replay_conf_t conf;
+  
+  
+  if ( !movie_record_waiting () ) return;
+  f= movie_state_open_write ();
+  if ( f == NULL ) return;
+  if ( GBC_save_state ( f ) != 0 )
+    {
+      warning ( "no s'ha pogut desar l'estat inicial de la pel·lícula" );
+      fclose ( f );
+      return;
+    }
+  memset ( &conf, 0, sizeof(conf) );
+  if ( *_bios != NULL )
+    {
+      conf.has_bios= 1;
+      memcpy ( conf.bios, *_bios, sizeof(conf.bios) );
+    }
+  replay_start_record ( &conf, f );
+  
+} // end start_record
+
+
 static void
 suspend_clear (
                const gboolean verbose
@@ -281,12 +323,11 @@ suspend (
 
 
 static void
-check_signals (
-               GBC_Bool *stop,
-               GBC_Bool *button_pressed,
-               GBC_Bool *direction_pressed,
-               void     *udata
-               )
+check_events (
+              GBC_Bool *stop,
+              GBC_Bool *button_pressed,
+              GBC_Bool *direction_pressed
+              )
 {
   
   SDL_Event event;
@@ -354,6 +395,23 @@ check_signals (
         
       }
   
+} /* end check_events */
+
+
+static void
+check_signals (
+               GBC_Bool *stop,
+               GBC_Bool *button_pressed,
+               GBC_Bool *direction_pressed,
+               void     *udata
+               )
+{
+
+  check_events ( stop, button_pressed, direction_pressed );
+  *button_pressed= movie_sample ( *button_pressed ) ? GBC_TRUE : GBC_FALSE;
+  *direction_pressed=
+    movie_sample ( *direction_pressed ) ? GBC_TRUE : GBC_FALSE;
+  
 } /* end check_signals */
 
 
@@ -366,10 +424,12 @@ loop (void)
 
   int cc,cc_iter;
   gint64 t0,tf,delay;
+  int64_t ts;
   GBC_Bool stop;
   
 
   screen_enable_cursor ( true );
+  frametime_restart ();
   stop= GBC_FALSE;
   t0= g_get_monotonic_time ();
   cc_iter= (int) ((GBC_CICLES_PER_SEC/1000000.0)*SLEEP + 0.5);
@@ -389,8 +449,14 @@ loop (void)
       // Delay
       tf= g_get_monotonic_time ();
       delay+= SLEEP-(tf-t0); t0= tf;
-      if ( delay >= SLEEP ) g_usleep ( SLEEP );
+      if ( delay >= SLEEP )
+        {
+          ts= frametime_begin ();
+          g_usleep ( SLEEP );
+          frametime_end ( FRAMETIME_SLEEP, ts );
+        }
       else if ( delay < MIN_DELAY ) delay= MIN_DELAY;
+      metrics_loop ( SLEEP, delay == MIN_DELAY );
       
     }
 
@@ -417,7 +483,7 @@ frontend_run_common (
       sram_get_external_ram,
       screen_update,
       check_signals,
-      pad_check_buttons,
+      pad_sample_buttons,
       sound_play,
       pad_update_rumble,
       NULL
@@ -429,6 +495,7 @@ frontend_run_common (
   
   *response= MENU_QUIT_MAINMENU;
   _quit= FALSE;
+  movie_stop_record ( "s'ha reinicialitzat el simulador" );
   init_sram ( rom_id, sram_fn, _verbose );
   init_state ( rom_id, state_prefix, _verbose );
   err= GBC_init ( *_bios, rom, &frontend, NULL );
@@ -463,6 +530,7 @@ frontend_run_common (
         }
       fclose ( f );
     }
+  start_record ();
   for (;;)
     {
       pad_clear ();
@@ -511,6 +579,7 @@ close_frontend (void)
 {
 
   close_t8biso ();
+  close_tiles8b ();
   close_pad ();
   close_sound ();
   close_screen ();
@@ -27,6 +27,7 @@
 #include <string.h>
 
 #include "effects.h"
+#include "frametime.h"
 #include "hud.h"
 #include "tiles8b.h"
 
@@ -42,6 +43,8 @@
 
 #define MSG_HEIGHT 11
 
+#define STATS_WIDTH ((FRAMETIME_HUD_COLS+1)*8)
+
 
 
 
@@ -225,6 +228,23 @@ render_flash (void)
 } /* end render_flash */ 
 
 
+static void
+render_stats (void)
+{
+
+  int i, y;
+  
+  
+  y= FB_HEIGHT - FRAMETIME_HUD_LINES*8;
+  effect_fade ( _fb, 0, y, STATS_WIDTH, FRAMETIME_HUD_LINES*8, 0.6 );
+  for ( i= 0; i < FRAMETIME_HUD_LINES; ++i )
+    tiles8b_draw_string ( &(_fb[y*FB_WIDTH]), FB_WIDTH,
+        		  frametime_hud_line ( i ), 0, i,
+        		  _style.fgcolor, 0, BG_TRANS );
+  
+} /* end render_stats */
+
+
 
 
 /**********************/
@@ -254,12 +274,18 @@ hud_update_fb (
                )
 {
 
+  bool stats;
+
+
   /* Comprova que cal fer algo. */
+  stats= frametime_hud_enabled ();
   if ( _msg.state == MSG_HIDDEN &&
-       _flash.state == FLS_STOP ) return fb;
+       _flash.state == FLS_STOP &&
+       !stats ) return fb;
   
   /* Renderitza. */
   memcpy ( _fb, fb, FB_WIDTH*FB_HEIGHT*sizeof(int) );
+  if ( stats ) render_stats ();
   if ( _msg.state != MSG_HIDDEN ) render_msg ();
   if ( _flash.state != FLS_STOP ) render_flash ();
   
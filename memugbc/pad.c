@@ -26,11 +26,13 @@
 #include <glib.h>
 #include <SDL.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "error.h"
 #include "GBC.h"
+#include "movie.h"
 #include "pad.h"
 
 
@@ -368,6 +370,15 @@ pad_check_buttons (
 } /* end pad_check_buttons */
 
 
+int
+pad_sample_buttons (
+        	    void *udata
+        	    )
+{
+  return (int) movie_sample ( (uint32_t) pad_check_buttons ( udata ) );
+} /* end pad_sample_buttons */
+
+
 void
 pad_clear (void)
 {
@@ -52,6 +52,14 @@ pad_check_buttons (
         	   void *udata
         	   );
 
+/* Com pad_check_buttons però enregistra/reprodueix la lectura en el
+ * moviment. Sols l'ha de cridar el simulador.
+ */
+int
+pad_sample_buttons (
+        	    void *udata
+        	    );
+
 void
 pad_clear (void);
 
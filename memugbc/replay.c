@@ -0,0 +1,301 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/memus.
+ *
+ * adriagipas/memus is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/memus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/memus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  replay.c - Implementació de 'replay.h'.
+ *
+ *  No s'inicialitza SDL. La RAM externa és una memòria temporal que
+ *  no es desa, el seu contingut ve de l'estat inicial de la
+ *  pel·lícula. La BIOS, si s'emprava, es desa en la pel·lícula.
+ *
+ */
+
+
+#include <glib.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+#include "framehash.h"
+#include "movie.h"
+#include "replay.h"
+
+
+
+
+/**********/
+/* MACROS */
+/**********/
+
+#define WIDTH 160
+#define HEIGHT 144
+
+// Configuració serialitzada en la pel·lícula. Cada camp s'escriu
+// explícitament perquè el format no depenga de com el compilador
+// organitza replay_conf_t: has_bios, bios (0x900 bytes).
+#define CONF_SIZE (1+0x900)
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+/* Fotogrames generats i màxim (0 sense límit). */
+static unsigned long _frames;
+static unsigned long _max_frames;
+
+/* RAM externa temporal. */
+static GBCu8 *_sram;
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static void
+_warning (
+          void       *udata,
+          const char *format,
+          ...
+          )
+{
+  
+  va_list ap;
+  
+  
+  va_start ( ap, format );
+  vwarning ( format, ap );
+  va_end ( ap );
+  
+} // end _warning
+
+
+static GBCu8 *
+get_external_ram (
+                  const size_t  nbytes,
+                  void         *udata
+                  )
+{
+  
+  g_free ( _sram );
+  _sram= g_new0 ( GBCu8, nbytes );
+  
+  return _sram;
+  
+} // end get_external_ram
+
+
+static void
+update_screen (
+               const int  fb[],
+               void      *udata
+               )
+{
+  
+  framehash_video ( fb, sizeof(int)*WIDTH*HEIGHT );
+  ++_frames;
+  
+} // end update_screen
+
+
+static void
+check (
+       GBC_Bool *stop,
+       GBC_Bool *button_pressed,
+       GBC_Bool *direction_pressed,
+       void     *udata
+       )
+{
+  
+  *button_pressed= movie_sample ( 0 ) ? GBC_TRUE : GBC_FALSE;
+  *direction_pressed= movie_sample ( 0 ) ? GBC_TRUE : GBC_FALSE;
+  *stop= (movie_end () || (_max_frames > 0 && _frames >= _max_frames)) ?
+    GBC_TRUE : GBC_FALSE;
+  
+} // end check
+
+
+static int
+check_buttons (
+               void *udata
+               )
+{
+  return (int) movie_sample ( 0 );
+} // end check_buttons
+
+
+static void
+play_sound (
+            const double  left[GBC_APU_BUFFER_SIZE],
+            const double  right[GBC_APU_BUFFER_SIZE],
+            void         *udata
+            )
+{
+  
+  framehash_audio ( left, sizeof(double)*GBC_APU_BUFFER_SIZE );
+  framehash_audio ( right, sizeof(double)*GBC_APU_BUFFER_SIZE );
+  
+} // end play_sound
+
+
+static void
+update_rumble (
+               const int  level,
+               void      *udata
+               )
+{
+} // end update_rumble
+
+
+static bool
+read_conf (
+           replay_conf_t *conf
+           )
+{
+
+  const uint8_t *buf;
+  
+
+  buf= movie_get_config ( CONF_SIZE );
+  if ( buf == NULL ) return false;
+  memset ( conf, 0, sizeof(*conf) );
+  conf->has_bios= buf[0]!=0;
+  memcpy ( conf->bios, &buf[1], 0x900 );
+  
+  return true;
+  
+} // end read_conf
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+bool
+replay_run (
+            const GBC_Rom       *rom,
+            const unsigned long  max_frames,
+            const bool           verbose
+            )
+{
+
+  static const GBC_Frontend frontend=
+    {
+      _warning,
+      get_external_ram,
+      update_screen,
+      check,
+      check_buttons,
+      play_sound,
+      update_rumble,
+      NULL
+    };
+  
+  replay_conf_t conf;
+  FILE *f;
+  GBC_Bool stop;
+  gint64 t0,tf;
+  uint64_t cc;
+  double secs;
+  int ret;
+  
+  
+  // Configuració.
+  if ( !read_conf ( &conf ) )
+    {
+      warning ( "la pel·lícula no té una configuració vàlida" );
+      return false;
+    }
+  
+  // Inicialitza.
+  _frames= 0;
+  _max_frames= max_frames;
+  _sram= NULL;
+  if ( GBC_init ( conf.has_bios ? conf.bios : NULL, rom, &frontend, NULL )
+       != GBC_NOERROR )
+    {
+      warning ( "no s'ha pogut inicialitzar el simulador" );
+      goto error;
+    }
+  f= movie_state_open_read ();
+  if ( f != NULL )
+    {
+      ret= GBC_load_state ( f );
+      fclose ( f );
+      if ( ret != 0 )
+        {
+          warning ( "l'estat inicial de la pel·lícula no és vàlid" );
+          goto error;
+        }
+    }
+  
+  // Executa.
+  t0= g_get_monotonic_time ();
+  cc= 0;
+  stop= GBC_FALSE;
+  while ( !stop )
+    cc+= GBC_iter ( &stop );
+  tf= g_get_monotonic_time ();
+  
+  // Estadístiques.
+  secs= (tf-t0)/1000000.0;
+  printf ( "Mostres:    %lu\n", (unsigned long) movie_get_nsamples () );
+  printf ( "Fotogrames: %lu\n", _frames );
+  printf ( "Cicles:     %lu\n", (unsigned long) cc );
+  printf ( "Temps:      %.3f s (%.1f fotogrames/s)\n",
+           secs, secs > 0 ? _frames/secs : 0.0 );
+  if ( verbose )
+    fprintf ( stderr, "Reproducció acabada\n" );
+  g_free ( _sram );
+  
+  return true;
+
+ error:
+  g_free ( _sram );
+  return false;
+  
+} // end replay_run
+
+
+bool
+replay_start_record (
+                     const replay_conf_t *conf,
+                     FILE                *state
+                     )
+{
+
+  uint8_t buf[CONF_SIZE];
+  
+
+  buf[0]= conf->has_bios ? 1 : 0;
+  memcpy ( &buf[1], conf->bios, 0x900 );
+  
+  return movie_start_record ( buf, CONF_SIZE, state );
+  
+} // end replay_start_record
@@ -29,6 +29,8 @@
 #include <SDL.h>
 
 #include "error.h"
+#include "frametime.h"
+#include "metrics.h"
 #include "sound.h"
 
 
@@ -160,8 +162,10 @@ sound_play (
   
   unsigned long j,new_j;
   int ret;
+  int64_t t0;
 
   
+  t0= frametime_begin ();
   j= (unsigned long) (_offset+0.5);
   aliasing_accum ( 0, j, left, right );
   while ( j < GBC_APU_BUFFER_SIZE )
@@ -190,9 +194,11 @@ sound_play (
     }
   if ( j < GBC_APU_BUFFER_SIZE )
     {
+      metrics_audio_dropped ( GBC_APU_BUFFER_SIZE-j );
       warning ( "S'han descartat mostres d'audio" );
       _offset= 0.0;
     }
   else _offset-= GBC_APU_BUFFER_SIZE;
+  frametime_end ( FRAMETIME_SOUND, t0 );
   
 } // end sound_play
@@ -30,9 +30,12 @@
 #include <stdlib.h>
 
 #include "error.h"
+#include "frametime.h"
 #include "frontend.h"
 #include "hud.h"
 #include "menu.h"
+#include "metrics.h"
+#include "movie.h"
 #include "pad.h"
 #include "rom.h"
 #include "screen.h"
@@ -217,6 +220,13 @@ load_state (
   FILE *f;
   
 
+  // Carregar un estat trencaria la pel·lícula.
+  if ( movie_is_recording () )
+    {
+      hud_show_msg ( "GRAVANT!" );
+      return;
+    }
+  
   f= state_open_read ( num );
   if ( f == NULL )
     {
@@ -236,6 +246,29 @@ load_state (
 } /* end load_state */
 
 
+// Comença la gravació preparada en main (si n'hi ha) a partir de
+// l'estat actual.
+static void
+start_record (void)
+{
+
+  FILE *f;
+  
+  
+  if ( !movie_record_waiting () ) return;
+  f= movie_state_open_write ();
+  if ( f == NULL ) return;
+  if ( GG_save_state ( f ) != 0 )
+    {
+      warning ( "no s'ha pogut desar l'estat inicial de la pel·lícula" );
+      fclose ( f );
+      return;
+    }
+  movie_start_record ( NULL, 0, f );
+  
+} // end start_record
+
+
 static void
 suspend_clear (
                const gboolean verbose
@@ -360,10 +393,12 @@ loop (void)
 
   int cc,cc_iter;
   gint64 t0,tf,delay;
+  int64_t ts;
   Z80_Bool stop;
   
   
   screen_enable_cursor ( true );
+  frametime_restart ();
   stop= Z80_FALSE;
   t0= g_get_monotonic_time ();
   cc_iter= (int) ((GG_CICLES_PER_SEC/1000000.0)*SLEEP + 0.5);
@@ -383,8 +418,14 @@ loop (void)
       // Delay
       tf= g_get_monotonic_time ();
       delay+= SLEEP-(tf-t0); t0= tf;
-      if ( delay >= SLEEP ) g_usleep ( SLEEP );
+      if ( delay >= SLEEP )
+        {
+          ts= frametime_begin ();
+          g_usleep ( SLEEP );
+          frametime_end ( FRAMETIME_SLEEP, ts );
+        }
       else if ( delay < MIN_DELAY ) delay= MIN_DELAY;
+      metrics_loop ( SLEEP, delay == MIN_DELAY );
       
     }
   
@@ -412,7 +453,7 @@ frontend_run_common (
       sram_get_external_ram,
       screen_update,
       check_signals,
-      pad_check_buttons,
+      pad_sample_buttons,
       sound_play,
       NULL
     };
@@ -438,6 +479,7 @@ frontend_run_common (
         }
       fclose ( f );
     }
+  start_record ();
   for (;;)
     {
       pad_clear ();
@@ -483,6 +525,7 @@ close_frontend (void)
 
   close_suspend ();
   close_t8biso ();
+  close_tiles8b ();
   close_pad ();
   close_sound ();
   close_screen ();
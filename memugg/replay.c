@@ -0,0 +1,225 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/memus.
+ *
+ * adriagipas/memus is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/memus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/memus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  replay.c - Implementació de 'replay.h'.
+ *
+ *  No s'inicialitza SDL. La RAM externa és una memòria temporal que
+ *  no es desa, el seu contingut ve de l'estat inicial de la
+ *  pel·lícula.
+ *
+ */
+
+
+#include <glib.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+#include "framehash.h"
+#include "movie.h"
+#include "replay.h"
+
+
+
+
+/**********/
+/* MACROS */
+/**********/
+
+#define SRAM_SIZE 0x8000
+
+#define WIDTH 160
+#define HEIGHT 144
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+/* Fotogrames generats i màxim (0 sense límit). */
+static unsigned long _frames;
+static unsigned long _max_frames;
+
+/* RAM externa temporal. */
+static Z80u8 _sram[SRAM_SIZE];
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static void
+_warning (
+          void       *udata,
+          const char *format,
+          ...
+          )
+{
+  
+  va_list ap;
+  
+  
+  va_start ( ap, format );
+  vwarning ( format, ap );
+  va_end ( ap );
+  
+} // end _warning
+
+
+static Z80u8 *
+get_external_ram (
+                  void *udata
+                  )
+{
+  
+  memset ( _sram, 0, SRAM_SIZE );
+  
+  return &(_sram[0]);
+  
+} // end get_external_ram
+
+
+static void
+update_screen (
+               const int  fb[],
+               void      *udata
+               )
+{
+  
+  framehash_video ( fb, sizeof(int)*WIDTH*HEIGHT );
+  ++_frames;
+  
+} // end update_screen
+
+
+static void
+check (
+       Z80_Bool *stop,
+       void     *udata
+       )
+{
+  *stop= (movie_end () || (_max_frames > 0 && _frames >= _max_frames)) ?
+    Z80_TRUE : Z80_FALSE;
+} // end check
+
+
+static int
+check_buttons (
+               void *udata
+               )
+{
+  return (int) movie_sample ( 0 );
+} // end check_buttons
+
+
+static void
+play_sound (
+            const double  left[GG_PSG_BUFFER_SIZE],
+            const double  right[GG_PSG_BUFFER_SIZE],
+            void         *udata
+            )
+{
+  
+  framehash_audio ( left, sizeof(double)*GG_PSG_BUFFER_SIZE );
+  framehash_audio ( right, sizeof(double)*GG_PSG_BUFFER_SIZE );
+  
+} // end play_sound
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+bool
+replay_run (
+            const GG_Rom        *rom,
+            const unsigned long  max_frames,
+            const bool           verbose
+            )
+{
+
+  static const GG_Frontend frontend=
+    {
+      _warning,
+      get_external_ram,
+      update_screen,
+      check,
+      check_buttons,
+      play_sound,
+      NULL
+    };
+  
+  FILE *f;
+  Z80_Bool stop;
+  gint64 t0,tf;
+  uint64_t cc;
+  double secs;
+  int ret;
+  
+  
+  // Inicialitza.
+  _frames= 0;
+  _max_frames= max_frames;
+  GG_init ( rom, &frontend, NULL );
+  f= movie_state_open_read ();
+  if ( f != NULL )
+    {
+      ret= GG_load_state ( f );
+      fclose ( f );
+      if ( ret != 0 )
+        {
+          warning ( "l'estat inicial de la pel·lícula no és vàlid" );
+          GG_close ();
+          return false;
+        }
+    }
+  
+  // Executa.
+  t0= g_get_monotonic_time ();
+  cc= 0;
+  stop= Z80_FALSE;
+  while ( !stop )
+    cc+= GG_iter ( &stop );
+  tf= g_get_monotonic_time ();
+  GG_close ();
+  
+  // Estadístiques.
+  secs= (tf-t0)/1000000.0;
+  printf ( "Mostres:    %lu\n", (unsigned long) movie_get_nsamples () );
+  printf ( "Fotogrames: %lu\n", _frames );
+  printf ( "Cicles:     %lu\n", (unsigned long) cc );
+  printf ( "Temps:      %.3f s (%.1f fotogrames/s)\n",
+           secs, secs > 0 ? _frames/secs : 0.0 );
+  if ( verbose )
+    fprintf ( stderr, "Reproducció acabada\n" );
+  
+  return true;
+  
+} // end replay_run
@@ -27,9 +27,11 @@
 #include <string.h>
 
 #include "error.h"
+#include "frametime.h"
 #include "hud.h"
 #include "icon.h"
 #include "lock.h"
+#include "metrics.h"
 #include "scalers2d.h"
 #include "screen.h"
 #include "windowfb.h"
@@ -308,9 +310,11 @@ screen_update (
   
   const int *hudfb;
   const int *auxfb;
+  int64_t t0;
   
 
   memcpy ( _last_fb, fb, sizeof(_last_fb) );
+  t0= frametime_begin ();
   hudfb= hud_update_fb ( fb );
   if ( _scaler.scaler == NULL ) auxfb= hudfb;
   else
@@ -318,7 +322,10 @@ screen_update (
       _scaler.scaler ( hudfb, _scaler.buffer, WIDTH, HEIGHT );
       auxfb= _scaler.buffer;
     }
+  frametime_end ( FRAMETIME_SCALER, t0 );
   windowfb_update ( auxfb, _palette );
+  frametime_frame ();
+  metrics_frame ();
   
 } /* end screen_update */
 
@@ -29,6 +29,8 @@
 #include <SDL.h>
 
 #include "error.h"
+#include "frametime.h"
+#include "metrics.h"
 #include "sound.h"
 
 
@@ -93,6 +95,7 @@ fill_audio_data (
   
   /* Ompli amb silencis el que quede. */
   if ( !len ) return;
+  metrics_audio_underrun ();
   while ( len )
     {
       *(p++)= _specs.silence;
@@ -161,8 +164,10 @@ sound_play (
     ((double) (GG_PSG_SAMPLES_PER_SEC) / (double) RATE);
   
   unsigned long j;
+  int64_t t0;
   
   
+  t0= frametime_begin ();
   SDL_LockAudioDevice ( _dev );
   
   j= (unsigned long) (_offset+0.5);
@@ -178,11 +183,13 @@ sound_play (
     }
   if ( j < GG_PSG_BUFFER_SIZE )
     {
+      metrics_audio_dropped ( GG_PSG_BUFFER_SIZE-j );
       warning ( "S'han descartat mostres d'audio" );
       _offset= 0.0;
     }
   else _offset-= GG_PSG_BUFFER_SIZE;
   
   SDL_UnlockAudioDevice ( _dev );
+  frametime_end ( FRAMETIME_SOUND, t0 );
   
 } /* end sound_play */
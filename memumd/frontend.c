@@ -28,14 +28,19 @@
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "eeprom.h"
 #include "error.h"
+#include "frametime.h"
 #include "frontend.h"
 #include "hud.h"
 #include "menu.h"
+#include "metrics.h"
 #include "model.h"
+#include "movie.h"
 #include "pad.h"
+#include "replay.h"
 #include "rom.h"
 #include "screen.h"
 #include "sound.h"
@@ -64,6 +69,9 @@ MD_Frontend _frontend;
 /* Cicles per segon actuals. */
 static int _ciclespersec;
 
+/* Dispositius connectats quan va començar la gravació. */
+static MD_IOPluggedDevices _record_devs;
+
 
 
 
@@ -231,6 +239,14 @@ load_state (
   int width, height;
   
   
+  // Carregar un estat trencaria la pel·lícula.
+  if ( movie_is_recording () )
+    {
+      screen_get_res ( &width, &height );
+      hud_show_msg ( "GRAVANT!", width );
+      return;
+    }
+  
   f= state_open_read ( num );
   if ( f == NULL )
     {
@@ -251,6 +267,35 @@ load_state (
 } /* end load_state */
 
 
+// Comença la gravació preparada en main (si n'hi ha) a partir de
+// l'estat actual.
+static void
+start_record (
+              const MDu8 model
+              )
+{
+
+  FILE *f;
+  replay_conf_t conf;
+  
+  
+  if ( !movie_record_waiting () ) return;
+  f= movie_state_open_write ();
+  if ( f == NULL ) return;
+  if ( MD_save_state ( f ) != 0 )
+    {
+      warning ( "no s'ha pogut desar l'estat inicial de la pel·lícula" );
+      fclose ( f );
+      return;
+    }
+  memset ( &conf, 0, sizeof(conf) );
+  conf.model= model;
+  conf.devs= _record_devs= _frontend.plugged_devs;
+  replay_start_record ( &conf, f );
+  
+} // end start_record
+
+
 static void
 suspend_clear (
                const gboolean verbose
@@ -303,7 +348,7 @@ check_signals (
   
   
   *stop= MD_FALSE;
-  *reset= _reset; _reset= FALSE;
+  *reset= (MD_Bool) movie_sample ( _reset ); _reset= FALSE;
   while ( screen_next_event ( &event ) )
     switch ( event.type )
       {
@@ -377,10 +422,12 @@ loop (void)
 
   int cc,cc_iter;
   gint64 t0,tf,delay;
+  int64_t ts;
   MD_Bool stop;
   
   
   screen_enable_cursor ( true );
+  frametime_restart ();
   stop= MD_FALSE;
   t0= g_get_monotonic_time ();
   cc_iter= (int) ((_ciclespersec/1000000.0)*SLEEP + 0.5);
@@ -400,8 +447,14 @@ loop (void)
       // Delay
       tf= g_get_monotonic_time ();
       delay+= SLEEP-(tf-t0); t0= tf;
-      if ( delay >= SLEEP ) g_usleep ( SLEEP );
+      if ( delay >= SLEEP )
+        {
+          ts= frametime_begin ();
+          g_usleep ( SLEEP );
+          frametime_end ( FRAMETIME_SLEEP, ts );
+        }
       else if ( delay < MIN_DELAY ) delay= MIN_DELAY;
+      metrics_loop ( SLEEP, delay == MIN_DELAY );
       
     }
   
@@ -426,6 +479,7 @@ frontend_run_common (
   menu_response_t ret;
   MDu8 model;
   FILE *f;
+  MD_IOPluggedDevices devs;
   
   
   ret= MENU_QUIT_MAINMENU;
@@ -452,6 +506,7 @@ frontend_run_common (
         }
       fclose ( f );
     }
+  start_record ( model );
   for (;;)
     {
       pad_clear ();
@@ -463,6 +518,11 @@ frontend_run_common (
           break;
         }
       ret= menu_run ( menu_mode );
+      devs= pad_get_devices ();
+      if ( ret == MENU_REINIT )
+        movie_stop_record ( "s'ha reinicialitzat el simulador" );
+      else if ( memcmp ( &devs, &_record_devs, sizeof(devs) ) != 0 )
+        movie_stop_record ( "s'han canviat els dispositius connectats" );
       if ( ret == MENU_RESET ) _reset= TRUE;
       else if ( ret == MENU_REINIT )
         {
@@ -517,6 +577,7 @@ close_frontend (void)
 {
 
   close_t8biso ();
+  close_tiles16b ();
   close_pad ();
   close_sound ();
   close_screen ();
@@ -627,6 +688,6 @@ init_frontend (
   _frontend.get_eeprom= eeprom_get_eeprom;
   _frontend.trace= NULL;
   _frontend.plugged_devs= conf->devs;
-  _frontend.check_buttons= pad_check_buttons;
+  _frontend.check_buttons= pad_sample_buttons;
   
 } // end init_frontend
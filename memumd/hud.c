@@ -30,6 +30,7 @@
 #include <string.h>
 
 #include "effects.h"
+#include "frametime.h"
 #include "hud.h"
 #include "tiles16b.h"
 
@@ -45,6 +46,7 @@
 #define MAXWIDTH 640
 #define MAXHEIGHT 480
 
+#define STATS_WIDTH ((FRAMETIME_HUD_COLS+1)*8)
 
 
 
@@ -236,6 +238,26 @@ render_flash (
 } /* end render_flash */
 
 
+static void
+render_stats (
+              const int width,
+              const int height
+              )
+{
+
+  int i, y;
+  
+  
+  y= height - FRAMETIME_HUD_LINES*16;
+  effect_fade ( _fb, width, 0, y, STATS_WIDTH, FRAMETIME_HUD_LINES*16, 0.6 );
+  for ( i= 0; i < FRAMETIME_HUD_LINES; ++i, y+= 16 )
+    tiles16b_draw_string ( _fb, width, frametime_hud_line ( i ), 4, y,
+        		   _style.fgcolor1, _style.fgcolor2,
+        		   0, T16_BG_TRANS|T16_XY_IN_PIXELS );
+  
+} /* end render_stats */
+
+
 
 
 /**********************/
@@ -267,13 +289,19 @@ hud_update_fb (
                const int  height
                )
 {
+
+  bool stats;
+  
   
   /* Comprova que cal fer algo. */
+  stats= frametime_hud_enabled ();
   if ( _msg.state == MSG_HIDDEN &&
-       _flash.state == FLS_STOP ) return fb;
+       _flash.state == FLS_STOP &&
+       !stats ) return fb;
   
   /* Renderitza. */
   memcpy ( _fb, fb, width*height*sizeof(int) );
+  if ( stats ) render_stats ( width, height );
   if ( _msg.state != MSG_HIDDEN ) render_msg ( width );
   if ( _flash.state != FLS_STOP ) render_flash ( width, height );
 
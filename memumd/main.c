@@ -34,9 +34,14 @@
 #include "conf.h"
 #include "dirs.h"
 #include "error.h"
+#include "framehash.h"
+#include "frametime.h"
 #include "frontend.h"
 #include "lock.h"
 #include "mainmenu.h"
+#include "metrics.h"
+#include "movie.h"
+#include "replay.h"
 #include "rom.h"
 #include "session.h"
 
@@ -81,6 +86,15 @@ struct opts
   gchar    *eeprom_fn;
   gchar    *state_prefix;
   gboolean  big_screen;
+  gchar    *record_fn;
+  gchar    *replay_fn;
+  gint      frames;
+  gchar    *golden_fn;
+  gboolean  write_golden;
+  gint      hash_period;
+  gboolean  frame_stats;
+  gchar    *frame_csv_fn;
+  gchar    *metrics_fn;
   
 };
 
@@ -111,7 +125,16 @@ usage (
       NULL,     /* sram_fn */
       NULL,     /* eeprom_fn */
       NULL,     /* state_prefix */
-      FALSE     /* big_screen */
+      FALSE,    /* big_screen */
+      NULL,     // record_fn
+      NULL,     // replay_fn
+      0,        // frames
+      NULL,     // golden_fn
+      FALSE,    // write_golden
+      60,       // hash_period
+      FALSE,    // frame_stats
+      NULL,     // frame_csv_fn
+      NULL      // metrics_fn
     };
   
   static GOptionEntry entries[]=
@@ -124,6 +147,38 @@ usage (
         " fa referència al fitxer de configuració de la ROM, sinó fa"
         " referència al fitxer de configuració per defecte",
         "CONF" },
+      { "frame-csv", 0, 0, G_OPTION_ARG_STRING, &vals.frame_csv_fn,
+        "Escriu en CSV el temps (en microsegons) que es gasta en cada"
+        " etapa de cada fotograma",
+        "CSV" },
+      { "frame-stats", 0, 0, G_OPTION_ARG_NONE, &vals.frame_stats,
+        "Mostra en pantalla els percentils del temps per fotograma i el"
+        " temps mitjà de cada etapa (en mil·lisegons)",
+        NULL },
+      { "metrics", 0, 0, G_OPTION_ARG_STRING, &vals.metrics_fn,
+        "Serveix mètriques en format de Prometheus en el socket UNIX SOCKET",
+        "SOCKET" },
+      { "record", 0, 0, G_OPTION_ARG_STRING, &vals.record_fn,
+        "Grava en MOVIE l'entrada dels controladors des de l'inici"
+        " (sols amb ROM)",
+        "MOVIE" },
+      { "replay", 0, 0, G_OPTION_ARG_STRING, &vals.replay_fn,
+        "Reprodueix MOVIE sense finestra ni so, tan ràpid com es puga,"
+        " i imprimeix estadístiques (sols amb ROM)",
+        "MOVIE" },
+      { "frames", 0, 0, G_OPTION_ARG_INT, &vals.frames,
+        "Amb --replay, para després de N fotogrames",
+        "N" },
+      { "golden", 0, 0, G_OPTION_ARG_STRING, &vals.golden_fn,
+        "Amb --replay, compara els hashos de la imatge i el so amb els"
+        " de GOLDEN i acaba amb error si no coincideixen",
+        "GOLDEN" },
+      { "write-golden", 0, 0, G_OPTION_ARG_NONE, &vals.write_golden,
+        "Amb --golden, escriu GOLDEN en compte de comparar",
+        NULL },
+      { "hash-period", 0, 0, G_OPTION_ARG_INT, &vals.hash_period,
+        "Amb --golden, calcula un hash cada N fotogrames (60 per defecte)",
+        "N" },
       { "print-header", 'H', 0, G_OPTION_ARG_NONE, &vals.print_header,
         "Imprimeix la capçalera de la ROM i surt (sols amb ROM)",
         NULL },
@@ -172,6 +227,12 @@ usage (
     error ( "número d'arguments incorrecte" );
   else if ( *argc-1 == 1 )
     args->rom_fn= (*argv)[1];
+  if ( opts->record_fn != NULL && opts->replay_fn != NULL )
+    error ( "no es pot gravar i reproduir al mateix temps" );
+  if ( opts->golden_fn != NULL && opts->replay_fn == NULL )
+    error ( "--golden sols es pot emprar amb --replay" );
+  if ( opts->frames < 0 || opts->hash_period <= 0 )
+    error ( "el nombre de fotogrames no és vàlid" );
   
 } /* end usage */
 
@@ -184,9 +245,14 @@ free_opts (
 
   if ( opts->session_name != NULL ) g_free ( opts->session_name );
   if ( opts->conf_fn != NULL ) g_free ( opts->conf_fn );
+  if ( opts->frame_csv_fn != NULL ) g_free ( opts->frame_csv_fn );
+  if ( opts->metrics_fn != NULL ) g_free ( opts->metrics_fn );
   if ( opts->title != NULL ) g_free ( opts->title );
   if ( opts->sram_fn != NULL ) g_free ( opts->sram_fn );
   if ( opts->eeprom_fn != NULL ) g_free ( opts->eeprom_fn );
+  if ( opts->record_fn != NULL ) g_free ( opts->record_fn );
+  if ( opts->replay_fn != NULL ) g_free ( opts->replay_fn );
+  if ( opts->golden_fn != NULL ) g_free ( opts->golden_fn );
   
 } /* end free_opts */
 
@@ -351,6 +417,22 @@ run_with_rom (
       goto quit;
     }
   
+  // Reprodueix.
+  if ( opts->replay_fn != NULL )
+    {
+      if ( opts->golden_fn != NULL )
+        init_framehash ( opts->golden_fn, opts->write_golden,
+                         opts->hash_period );
+      if ( !init_movie_replay ( opts->replay_fn, "MD", rom_id,
+                                opts->verbose ) ||
+           !replay_run ( &rom, opts->frames, opts->verbose ) )
+        error ( "no s'ha pogut reproduir '%s'", opts->replay_fn );
+      close_movie ();
+      if ( !close_framehash () )
+        error ( "la reproducció no coincideix amb '%s'", opts->golden_fn );
+      goto quit;
+    }
+  
   // Inicialitza.
   init_session ( opts->session_name, opts->verbose );
   if ( init_lock ( rom_id, opts->verbose ) )
@@ -362,9 +444,12 @@ run_with_rom (
       g_free ( title );
       
       // Executa.
+      if ( opts->record_fn != NULL )
+        init_movie_record ( opts->record_fn, "MD", rom_id, opts->verbose );
       frontend_run ( &rom, &header, rom_id, opts->sram_fn, opts->eeprom_fn,
                      opts->state_prefix, MENU_MODE_INGAME_NOMAINMENU,
                      NULL, opts->verbose );
+      close_movie ();
       
       // Allibera memòria. i tanca
       close_frontend ();
@@ -433,8 +518,14 @@ int main ( int argc, char *argv[] )
   usage ( &argc, &argv, &args, &opts );
   
   /* Executa. */
+  if ( opts.frame_stats || opts.frame_csv_fn != NULL )
+    init_frametime ( opts.frame_stats, opts.frame_csv_fn );
+  if ( opts.metrics_fn != NULL )
+    init_metrics ( opts.metrics_fn, "MD" );
   if ( args.rom_fn != NULL ) run_with_rom ( &args, &opts );
   else                       run_without_rom ( &args, &opts );
+  close_metrics ();
+  close_frametime ();
   
   /* Despedida. */
   free_opts ( &opts );
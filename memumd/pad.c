@@ -26,11 +26,13 @@
 #include <glib.h>
 #include <SDL.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "error.h"
 #include "MD.h"
+#include "movie.h"
 #include "pad.h"
 
 
@@ -361,6 +363,16 @@ pad_check_buttons (
 } /* end pad_check_buttons */
 
 
+int
+pad_sample_buttons (
+        	    const int  pad,
+        	    void      *udata
+        	    )
+{
+  return (int) movie_sample ( (uint32_t) pad_check_buttons ( pad, udata ) );
+} /* end pad_sample_buttons */
+
+
 void
 pad_clear (void)
 {
@@ -49,6 +49,15 @@ pad_check_buttons (
         	   void      *udata
         	   );
 
+/* Com pad_check_buttons però enregistra/reprodueix la lectura en el
+ * moviment. Sols l'ha de cridar el simulador.
+ */
+int
+pad_sample_buttons (
+        	    const int  pad,
+        	    void      *udata
+        	    );
+
 void
 pad_clear (void);
 
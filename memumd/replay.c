@@ -0,0 +1,327 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/memus.
+ *
+ * adriagipas/memus is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/memus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/memus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  replay.c - Implementació de 'replay.h'.
+ *
+ *  No s'inicialitza SDL. La SRAM i la EEPROM són memòries temporals
+ *  que no es desen, el seu contingut ve de l'estat inicial de la
+ *  pel·lícula.
+ *
+ */
+
+
+#include <glib.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+#include "framehash.h"
+#include "movie.h"
+#include "replay.h"
+
+
+
+
+/**********/
+/* MACROS */
+/**********/
+
+// Configuració serialitzada en la pel·lícula. Cada camp s'escriu
+// explícitament perquè el format no depenga de com el compilador
+// organitza replay_conf_t: model, dev1, dev2, dev_exp.
+#define CONF_SIZE 4
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+/* Fotogrames generats i màxim (0 sense límit). */
+static unsigned long _frames;
+static unsigned long _max_frames;
+
+/* Resolució actual (per defecte la de screen.c). */
+static int _width;
+static int _height;
+
+/* Memòries temporals. */
+static MD_Word *_sram;
+static MDu8 *_eeprom;
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static void
+_warning (
+          void       *udata,
+          const char *format,
+          ...
+          )
+{
+  
+  va_list ap;
+  
+  
+  va_start ( ap, format );
+  vwarning ( format, ap );
+  va_end ( ap );
+  
+} // end _warning
+
+
+static void
+check (
+       MD_Bool *stop,
+       MD_Bool *reset,
+       void    *udata
+       )
+{
+
+  *reset= (MD_Bool) movie_sample ( 0 );
+  *stop= (movie_end () || (_max_frames > 0 && _frames >= _max_frames)) ?
+    MD_TRUE : MD_FALSE;
+  
+} // end check
+
+
+static void
+sres_changed (
+              const int  width,
+              const int  height,
+              void      *udata
+              )
+{
+  
+  _width= width;
+  _height= height;
+  
+} // end sres_changed
+
+
+static void
+update_screen (
+               const int  fb[],
+               void      *udata
+               )
+{
+  
+  framehash_video ( fb, sizeof(int)*_width*_height );
+  ++_frames;
+  
+} // end update_screen
+
+
+static void
+play_sound (
+            const MDs16  samples[MD_FM_BUFFER_SIZE*2],
+            void        *udata
+            )
+{
+  framehash_audio ( samples, sizeof(MDs16)*MD_FM_BUFFER_SIZE*2 );
+} // end play_sound
+
+
+static MD_Word *
+get_static_ram (
+                const int  num_words,
+                void      *udata
+                )
+{
+
+  g_free ( _sram );
+  _sram= g_new0 ( MD_Word, num_words );
+  
+  return _sram;
+  
+} // end get_static_ram
+
+
+static MDu8 *
+get_eeprom (
+            const size_t  nbytes,
+            const MDu8    init_val,
+            void         *udata
+            )
+{
+
+  g_free ( _eeprom );
+  _eeprom= g_new ( MDu8, nbytes );
+  memset ( _eeprom, init_val, nbytes );
+  
+  return _eeprom;
+  
+} // end get_eeprom
+
+
+static int
+check_buttons (
+               const int  pad,
+               void      *udata
+               )
+{
+  return (int) movie_sample ( 0 );
+} // end check_buttons
+
+
+static bool
+read_conf (
+           replay_conf_t *conf
+           )
+{
+
+  const uint8_t *buf;
+  
+
+  buf= movie_get_config ( CONF_SIZE );
+  if ( buf == NULL ) return false;
+  memset ( conf, 0, sizeof(*conf) );
+  conf->model= (MDu8) buf[0];
+  conf->devs.dev1= buf[1];
+  conf->devs.dev2= buf[2];
+  conf->devs.dev_exp= buf[3];
+  
+  return true;
+  
+} // end read_conf
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+bool
+replay_run (
+            const MD_Rom        *rom,
+            const unsigned long  max_frames,
+            const bool           verbose
+            )
+{
+
+  MD_Frontend frontend;
+  replay_conf_t conf;
+  FILE *f;
+  MD_Bool stop;
+  gint64 t0,tf;
+  uint64_t cc;
+  double secs;
+  int ret;
+  
+  
+  // Configuració.
+  if ( !read_conf ( &conf ) )
+    {
+      warning ( "la pel·lícula no té una configuració vàlida" );
+      return false;
+    }
+  frontend.warning= _warning;
+  frontend.check= check;
+  frontend.sres_changed= sres_changed;
+  frontend.update_screen= update_screen;
+  frontend.play_sound= play_sound;
+  frontend.get_static_ram= get_static_ram;
+  frontend.get_eeprom= get_eeprom;
+  frontend.trace= NULL;
+  frontend.plugged_devs= conf.devs;
+  frontend.check_buttons= check_buttons;
+
+  // Inicialitza.
+  _frames= 0;
+  _max_frames= max_frames;
+  _width= 320;
+  _height= 240;
+  _sram= NULL;
+  _eeprom= NULL;
+  MD_init ( rom, conf.model, &frontend, NULL );
+  f= movie_state_open_read ();
+  if ( f != NULL )
+    {
+      ret= MD_load_state ( f );
+      fclose ( f );
+      if ( ret != 0 )
+        {
+          warning ( "l'estat inicial de la pel·lícula no és vàlid" );
+          goto error;
+        }
+    }
+  
+  // Executa.
+  t0= g_get_monotonic_time ();
+  cc= 0;
+  stop= MD_FALSE;
+  while ( !stop )
+    cc+= MD_iter ( &stop );
+  tf= g_get_monotonic_time ();
+  
+  // Estadístiques.
+  secs= (tf-t0)/1000000.0;
+  printf ( "Mostres:    %lu\n", (unsigned long) movie_get_nsamples () );
+  printf ( "Fotogrames: %lu\n", _frames );
+  printf ( "Cicles:     %lu\n", (unsigned long) cc );
+  printf ( "Temps:      %.3f s (%.1f fotogrames/s)\n",
+           secs, secs > 0 ? _frames/secs : 0.0 );
+  if ( verbose )
+    fprintf ( stderr, "Reproducció acabada\n" );
+  
+  // Allibera.
+  MD_close ();
+  g_free ( _sram );
+  g_free ( _eeprom );
+  
+  return true;
+
+ error:
+  MD_close ();
+  g_free ( _sram );
+  g_free ( _eeprom );
+  return false;
+  
+} // end replay_run
+
+
+bool
+replay_start_record (
+                     const replay_conf_t *conf,
+                     FILE                *state
+                     )
+{
+
+  uint8_t buf[CONF_SIZE];
+  
+
+  buf[0]= (uint8_t) conf->model;
+  buf[1]= (uint8_t) conf->devs.dev1;
+  buf[2]= (uint8_t) conf->devs.dev2;
+  buf[3]= (uint8_t) conf->devs.dev_exp;
+  
+  return movie_start_record ( buf, CONF_SIZE, state );
+  
+} // end replay_start_record
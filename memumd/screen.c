@@ -28,9 +28,11 @@
 
 #include "MD.h"
 #include "error.h"
+#include "frametime.h"
 #include "hud.h"
 #include "icon.h"
 #include "lock.h"
+#include "metrics.h"
 #include "scalers2d.h"
 #include "screen.h"
 #include "windowfb.h"
@@ -345,9 +347,11 @@ screen_update (
 
   const int *auxfb;
   const int *hudfb;
+  int64_t t0;
   
   
   memcpy ( _last_fb, fb, _res.width*_res.height*sizeof(int) );
+  t0= frametime_begin ();
   hudfb= hud_update_fb ( fb, _res.width, _res.height );
   if ( _scaler.scaler == NULL ) auxfb= hudfb;
   else
@@ -355,7 +359,10 @@ screen_update (
       _scaler.scaler ( hudfb, _scaler.buffer, _res.width, _res.height );
       auxfb= _scaler.buffer;
     }
+  frametime_end ( FRAMETIME_SCALER, t0 );
   windowfb_update ( auxfb, _palette );
+  frametime_frame ();
+  metrics_frame ();
   
 } /* end screen_update */
 
@@ -29,6 +29,8 @@
 #include <SDL.h>
 
 #include "error.h"
+#include "frametime.h"
+#include "metrics.h"
 #include "sound.h"
 
 
@@ -107,6 +109,7 @@ fill_audio_data (
   
   /* Ompli amb silencis el que quede. */
   if ( !len ) return;
+  metrics_audio_underrun ();
   while ( len )
     {
       *(p++)= _specs.silence;
@@ -172,8 +175,10 @@ sound_play (
 {
   
   unsigned long j;
+  int64_t t0;
   
   
+  t0= frametime_begin ();
   SDL_LockAudioDevice ( _dev );
   
   j= (unsigned long) (_offset+0.5);
@@ -189,12 +194,14 @@ sound_play (
     }
   if ( j < MD_FM_BUFFER_SIZE )
     {
+      metrics_audio_dropped ( MD_FM_BUFFER_SIZE-j );
       warning ( "S'han descartat mostres d'audio" );
       _offset= 0.0;
     }
   else _offset-= MD_FM_BUFFER_SIZE;
   
   SDL_UnlockAudioDevice ( _dev );
+  frametime_end ( FRAMETIME_SOUND, t0 );
   
 } // end sound_play
 
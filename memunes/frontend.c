@@ -30,12 +30,17 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "error.h"
+#include "frametime.h"
 #include "frontend.h"
 #include "hud.h"
 #include "menu.h"
+#include "metrics.h"
+#include "movie.h"
 #include "pad.h"
+#include "replay.h"
 #include "rom.h"
 #include "screen.h"
 #include "sound.h"
@@ -227,6 +232,13 @@ load_state (
   FILE *f;
   
   
+  // Carregar un estat trencaria la pel·lícula.
+  if ( movie_is_recording () )
+    {
+      hud_show_msg ( "GRAVANT!" );
+      return;
+    }
+  
   f= state_open_read ( num );
   if ( f == NULL )
     {
@@ -246,6 +258,34 @@ load_state (
 } /* end load_state */
 
 
+// Comença la gravació preparada en main (si n'hi ha) a partir de
+// l'estat actual.
+static void
+start_record (
+              const NES_TVMode tvmode
+              )
+{
+
+  FILE *f;
+  replay_conf_t conf;
+  
+  
+  if ( !movie_record_waiting () ) return;
+  f= movie_state_open_write ();
+  if ( f == NULL ) return;
+  if ( NES_save_state ( f ) != 0 )
+    {
+      warning ( "no s'ha pogut desar l'estat inicial de la pel·lícula" );
+      fclose ( f );
+      return;
+    }
+  memset ( &conf, 0, sizeof(conf) );
+  conf.tvmode= tvmode;
+  replay_start_record ( &conf, f );
+  
+} // end start_record
+
+
 static void
 suspend_clear (
                const gboolean verbose
@@ -298,7 +338,7 @@ check_signals (
   
   
   *stop= NES_FALSE;
-  *reset= _reset; _reset= FALSE;
+  *reset= movie_sample ( _reset ) ? NES_TRUE : NES_FALSE; _reset= FALSE;
   while ( screen_next_event ( &event ) )
     switch ( event.type )
       {
@@ -372,10 +412,12 @@ loop (void)
 
   int cc,cc_iter;
   gint64 t0,tf,delay;
+  int64_t ts;
   NES_Bool stop;
   
 
   screen_enable_cursor ( true );
+  frametime_restart ();
   stop= NES_FALSE;
   t0= g_get_monotonic_time ();
   cc_iter= (int) ((_ciclespersec/1000000.0)*SLEEP + 0.5);
@@ -395,8 +437,14 @@ loop (void)
       // Delay
       tf= g_get_monotonic_time ();
       delay+= SLEEP-(tf-t0); t0= tf;
-      if ( delay >= SLEEP ) g_usleep ( SLEEP );
+      if ( delay >= SLEEP )
+        {
+          ts= frametime_begin ();
+          g_usleep ( SLEEP );
+          frametime_end ( FRAMETIME_SLEEP, ts );
+        }
       else if ( delay < MIN_DELAY ) delay= MIN_DELAY;
+      metrics_loop ( SLEEP, delay == MIN_DELAY );
       
     }
   
@@ -485,6 +533,7 @@ frontend_run_common (
         }
       fclose ( f );
     }
+  start_record ( tvmode );
   for (;;)
     {
       pad_clear ();
@@ -499,6 +548,7 @@ frontend_run_common (
       if ( ret == MENU_RESET ) _reset= TRUE;
       else if ( ret == MENU_REINIT )
         {
+          movie_stop_record ( "s'ha reinicialitzat el simulador" );
           close_sram ();
           tvmode= tvmode_get_val ();
           _ciclespersec= (tvmode==NES_PAL) ?
@@ -546,6 +596,7 @@ close_frontend (void)
 {
 
   close_t8biso ();
+  close_tiles8b ();
   close_pad ();
   close_sound ();
   close_screen ();
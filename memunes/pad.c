@@ -31,6 +31,7 @@
 
 #include "error.h"
 #include "NES.h"
+#include "movie.h"
 #include "pad.h"
 
 
@@ -357,7 +358,8 @@ pad_check_pad1_buttons (
         		void          *udata
         		)
 {
-  return (pad_check_buttons ( 0 )&(1<<button))!=0;
+  return (NES_Bool)
+    movie_sample ( (pad_check_buttons ( 0 )&(1<<button))!=0 );
 } /* end pad_check_pad1_buttons */
 
 
@@ -367,7 +369,8 @@ pad_check_pad2_buttons (
         		void          *udata
         		)
 {
-  return (pad_check_buttons ( 1 )&(1<<button))!=0;
+  return (NES_Bool)
+    movie_sample ( (pad_check_buttons ( 1 )&(1<<button))!=0 );
 } /* end pad_check_pad2_buttons */
 
 
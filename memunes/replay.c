@@ -0,0 +1,264 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/memus.
+ *
+ * adriagipas/memus is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/memus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/memus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  replay.c - Implementació de 'replay.h'.
+ *
+ *  No s'inicialitza SDL. La PRG-RAM és una memòria temporal que no
+ *  es desa, el seu contingut ve de l'estat inicial de la pel·lícula.
+ *
+ */
+
+
+#include <glib.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+#include "framehash.h"
+#include "movie.h"
+#include "replay.h"
+
+
+
+
+/**********/
+/* MACROS */
+/**********/
+
+// Configuració serialitzada en la pel·lícula. Cada camp s'escriu
+// explícitament perquè el format no depenga de com el compilador
+// organitza replay_conf_t: tvmode.
+#define CONF_SIZE 1
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+/* Fotogrames generats i màxim (0 sense límit). */
+static unsigned long _frames;
+static unsigned long _max_frames;
+
+/* Files de la pantalla segons el mode de TV. */
+static int _rows;
+
+/* PRG-RAM temporal. */
+static NESu8 _prgram[0x2000];
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static void
+_warning (
+          void       *udata,
+          const char *format,
+          ...
+          )
+{
+  
+  va_list ap;
+  
+  
+  va_start ( ap, format );
+  vwarning ( format, ap );
+  va_end ( ap );
+  
+} // end _warning
+
+
+static void
+update_screen (
+               const int  fb[],
+               void      *udata
+               )
+{
+  
+  framehash_video ( fb, sizeof(int)*NES_PPU_COLS*_rows );
+  ++_frames;
+  
+} // end update_screen
+
+
+static void
+play_sound (
+            const double  frame[NES_APU_BUFFER_SIZE],
+            void         *udata
+            )
+{
+  framehash_audio ( frame, sizeof(double)*NES_APU_BUFFER_SIZE );
+} // end play_sound
+
+
+static NES_Bool
+check_pad_buttons (
+                   NES_PadButton  button,
+                   void          *udata
+                   )
+{
+  return movie_sample ( 0 ) ? NES_TRUE : NES_FALSE;
+} // end check_pad_buttons
+
+
+static void
+check (
+       NES_Bool *reset,
+       NES_Bool *stop,
+       void     *udata
+       )
+{
+
+  *reset= movie_sample ( 0 ) ? NES_TRUE : NES_FALSE;
+  *stop= (movie_end () || (_max_frames > 0 && _frames >= _max_frames)) ?
+    NES_TRUE : NES_FALSE;
+  
+} // end check
+
+
+static bool
+read_conf (
+           replay_conf_t *conf
+           )
+{
+
+  const uint8_t *buf;
+  
+
+  buf= movie_get_config ( CONF_SIZE );
+  if ( buf == NULL ) return false;
+  memset ( conf, 0, sizeof(*conf) );
+  conf->tvmode= buf[0];
+  
+  return true;
+  
+} // end read_conf
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+bool
+replay_run (
+            const NES_Rom       *rom,
+            const unsigned long  max_frames,
+            const bool           verbose
+            )
+{
+
+  static const NES_Frontend frontend=
+    {
+      _warning,
+      update_screen,
+      play_sound,
+      check_pad_buttons,
+      check_pad_buttons,
+      check,
+      NULL
+    };
+  
+  replay_conf_t conf;
+  FILE *f;
+  NES_Bool stop;
+  gint64 t0,tf;
+  uint64_t cc;
+  double secs;
+  int ret;
+  
+  
+  // Configuració.
+  if ( !read_conf ( &conf ) )
+    {
+      warning ( "la pel·lícula no té una configuració vàlida" );
+      return false;
+    }
+  
+  // Inicialitza.
+  _frames= 0;
+  _max_frames= max_frames;
+  _rows= conf.tvmode==NES_PAL ? NES_PPU_PAL_ROWS : NES_PPU_NTSC_ROWS;
+  memset ( _prgram, 0, sizeof(_prgram) );
+  if ( NES_init ( rom, conf.tvmode, &frontend, _prgram, NULL ) !=
+       NES_NOERROR )
+    {
+      warning ( "no s'ha pogut inicialitzar el simulador" );
+      return false;
+    }
+  f= movie_state_open_read ();
+  if ( f != NULL )
+    {
+      ret= NES_load_state ( f );
+      fclose ( f );
+      if ( ret != 0 )
+        {
+          warning ( "l'estat inicial de la pel·lícula no és vàlid" );
+          return false;
+        }
+    }
+  
+  // Executa.
+  t0= g_get_monotonic_time ();
+  cc= 0;
+  stop= NES_FALSE;
+  while ( !stop )
+    cc+= NES_iter ( &stop );
+  tf= g_get_monotonic_time ();
+  
+  // Estadístiques.
+  secs= (tf-t0)/1000000.0;
+  printf ( "Mostres:    %lu\n", (unsigned long) movie_get_nsamples () );
+  printf ( "Fotogrames: %lu\n", _frames );
+  printf ( "Cicles:     %lu\n", (unsigned long) cc );
+  printf ( "Temps:      %.3f s (%.1f fotogrames/s)\n",
+           secs, secs > 0 ? _frames/secs : 0.0 );
+  if ( verbose )
+    fprintf ( stderr, "Reproducció acabada\n" );
+  
+  return true;
+  
+} // end replay_run
+
+
+bool
+replay_start_record (
+                     const replay_conf_t *conf,
+                     FILE                *state
+                     )
+{
+
+  uint8_t buf[CONF_SIZE];
+  
+
+  buf[0]= (uint8_t) conf->tvmode;
+  
+  return movie_start_record ( buf, CONF_SIZE, state );
+  
+} // end replay_start_record
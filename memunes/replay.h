@@ -0,0 +1,61 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/memus.
+ *
+ * adriagipas/memus is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/memus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/memus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  replay.h - Reproducció de pel·lícules sense finestra ni so.
+ *
+ */
+
+#ifndef __REPLAY_H__
+#define __REPLAY_H__
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "NES.h"
+
+/* Configuració que es desa en la pel·lícula. */
+typedef struct
+{
+
+  NES_TVMode tvmode;
+
+} replay_conf_t;
+
+/* Reprodueix la pel·lícula oberta amb init_movie_replay fins al
+ * final, tan ràpid com es puga, i imprimeix estadístiques. Torna
+ * false si la pel·lícula no es pot reproduir.
+ */
+bool
+replay_run (
+            const NES_Rom       *rom,
+            const unsigned long  max_frames, // 0 sense límit
+            const bool           verbose
+            );
+
+/* Comença la gravació preparada amb init_movie_record desant 'conf'
+ * en la pel·lícula. 'state' és el fitxer tornat per
+ * movie_state_open_write amb l'estat inicial ja desat.
+ */
+bool
+replay_start_record (
+                     const replay_conf_t *conf,
+                     FILE                *state
+                     );
+
+#endif // __REPLAY_H__
@@ -29,9 +29,11 @@
 
 #include "NES.h"
 #include "error.h"
+#include "frametime.h"
 #include "hud.h"
 #include "icon.h"
 #include "lock.h"
+#include "metrics.h"
 #include "scalers2d.h"
 #include "screen.h"
 #include "windowfb.h"
@@ -348,9 +350,11 @@ screen_update (
   
   const int *auxfb;
   const int *hudfb;
+  int64_t t0;
   
   
   memcpy ( _last_fb, fb, WIDTH*MAXHEIGHT*sizeof(int) );
+  t0= frametime_begin ();
   hudfb= hud_update_fb ( &(fb[0])+_tvmode.fb_off, _tvmode.height );
   if ( _scaler.scaler == NULL ) auxfb= hudfb;
   else
@@ -358,7 +362,10 @@ screen_update (
       _scaler.scaler ( hudfb, _scaler.buffer, WIDTH, _tvmode.height );
       auxfb= _scaler.buffer;
     }
+  frametime_end ( FRAMETIME_SCALER, t0 );
   windowfb_update ( auxfb, _palette );
+  frametime_frame ();
+  metrics_frame ();
   
 } /* end screen_update */
 
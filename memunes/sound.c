@@ -30,6 +30,8 @@
 #include <SDL.h>
 
 #include "error.h"
+#include "frametime.h"
+#include "metrics.h"
 #include "sound.h"
 
 
@@ -97,6 +99,7 @@ fill_audio_data (
 
   
   /* Ompli amb silencis el que quede. */
+  if ( len ) metrics_audio_underrun ();
   while ( len )
     {
       *(p++)= _specs.silence;
@@ -164,8 +167,10 @@ sound_play (
 {
   
   unsigned long j;
+  int64_t t0;
   
   
+  t0= frametime_begin ();
   SDL_LockAudioDevice ( _dev );
   
   j= (unsigned long) (_offset+0.5);
@@ -179,6 +184,7 @@ sound_play (
     }
   if ( j < NES_APU_BUFFER_SIZE )
     {
+      metrics_audio_dropped ( NES_APU_BUFFER_SIZE-j );
       warning ( "S'han descartat mostres d'audio" );
       _offset= 0.0;
     }
@@ -191,6 +197,7 @@ sound_play (
       SDL_PauseAudioDevice ( _dev, 0 );
       _paused= false;
     }
+  frametime_end ( FRAMETIME_SOUND, t0 );
   
 } /* end sound_play */
 
@@ -37,15 +37,6 @@
 
 
 
-/**********/
-/* MACROS */
-/**********/
-
-#define CMOS_RAM_SIZE 256
-
-
-
-
 /*********/
 /* ESTAT */
 /*********/
@@ -77,6 +68,36 @@ get_tmp_file_name (void)
 } // end get_cmos_tmp_file_name 
 
 
+// Llig la CMOS desada en 'mem', o la inicialitza a 0 si no està.
+static void
+read_cmos_ram (
+               uint8_t *mem
+               )
+{
+  
+  FILE *f;
+  gchar *name;
+  
+  
+  name= get_cmos_ram_file_name ();
+  if ( g_file_test ( name, G_FILE_TEST_IS_REGULAR ) )
+    {
+      if ( _verbose )
+        fprintf ( stderr, "Llegint la memòria de la CMOS de '%s'\n", name );
+      f= fopen ( name, "rb" );
+      if ( f == NULL )
+        error ( "no s'ha pogut obrir '%s': %s", name, strerror ( errno )  );
+      if ( fread ( mem, CMOS_RAM_SIZE, 1, f ) != 1 )
+        error ( "no s'ha pogut llegir la CMOS de '%s': %s",
+        	name, strerror ( errno ) );
+      fclose ( f );
+    }
+  else memset ( mem, 0, CMOS_RAM_SIZE );
+  g_free ( name );
+  
+} // end read_cmos_ram
+
+
 
 
 /**********************/
@@ -146,28 +167,19 @@ cmos_get_ram (
               )
 {
   
-  FILE *f;
-  gchar *name;
-  
-  
   // Busca si existeix el fitxer i carrega'l o inicialitza a 0 si no
   // està.
-  name= get_cmos_ram_file_name ();
-  if ( g_file_test ( name, G_FILE_TEST_IS_REGULAR ) )
-    {
-      if ( _verbose )
-        fprintf ( stderr, "Llegint la memòria de la CMOS de '%s'\n", name );
-      f= fopen ( name, "rb" );
-      if ( f == NULL )
-        error ( "no s'ha pogut obrir '%s': %s", name, strerror ( errno )  );
-      if ( fread ( _mem, CMOS_RAM_SIZE, 1, f ) != 1 )
-        error ( "no s'ha pogut llegir la CMOS de '%s': %s",
-        	name, strerror ( errno ) );
-      fclose ( f );
-    }
-  else memset ( _mem, 0, CMOS_RAM_SIZE );
-  g_free ( name );
+  read_cmos_ram ( _mem );
   
   return &_mem[0];
   
 } // end cmos_get_ram
+
+
+void
+cmos_get_saved (
+                uint8_t mem[CMOS_RAM_SIZE]
+                )
+{
+  read_cmos_ram ( mem );
+} // end cmos_get_saved
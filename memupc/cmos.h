@@ -27,6 +27,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#define CMOS_RAM_SIZE 256
+
 void
 close_cmos (void);
 
@@ -40,4 +42,11 @@ cmos_get_ram (
               void *udata
               );
 
+// Copia en 'mem' la CMOS desada, és a dir, el que rep el simulador
+// cada vegada que s'inicialitza. No modifica la CMOS en ús.
+void
+cmos_get_saved (
+                uint8_t mem[CMOS_RAM_SIZE]
+                );
+
 #endif // __CMOS_H__
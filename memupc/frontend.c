@@ -33,11 +33,15 @@
 
 #include "cmos.h"
 #include "error.h"
+#include "frametime.h"
 #include "frontend.h"
 #include "load_bios.h"
 #include "load_hdd.h"
 #include "load_vgabios.h"
 #include "menu.h"
+#include "metrics.h"
+#include "movie.h"
+#include "replay.h"
 #include "screen.h"
 #include "sound.h"
 #include "tiles8b.h"
@@ -63,9 +67,24 @@ static bool _quit;
 // Per a indicar que des de el menú s'ha fet un reset.
 static bool _reset;
 
+// Mode turbo: el simulador s'executa tan ràpid com pot. Els
+// temporitzadors del PC van en temps simulat, per tant el sistema
+// convidat no nota la diferència.
+static bool _turbo;
+
 // Frontend.
 static PC_Frontend _frontend;
 
+// Última hora que ha rebut el simulador, per a l'estat inicial de
+// les pel·lícules.
+static replay_time_t _time;
+static bool _time_set;
+
+// Cicles executats de més en l'últim tros. No es torna a 0 en
+// reentrar en 'loop' (després del menú), sols en l'encesa, perquè els
+// trossos caiguen en els mateixos cicles que en la reproducció.
+static int _cc;
+
 // Dispositius IDE connectats.
 static PC_IDEDevice _ide_devices[2][2];
 
@@ -167,8 +186,7 @@ get_current_time (
   *year= g_date_time_get_year ( date );
   g_time_zone_unref ( tz );
   g_date_time_unref ( date );
-  
-  return;
+  goto sample;
   
  error:
   warning ( udata, "no s'ha pogut obtindre l'hora i data actuals,"
@@ -183,6 +201,17 @@ get_current_time (
   if ( tz == NULL ) g_time_zone_unref ( tz );
   if ( date == NULL ) g_date_time_unref ( date );
   
+  // Gravant, l'hora es desa en la pel·lícula.
+ sample:
+  _time.ss= *ss= (uint8_t) movie_sample ( *ss );
+  _time.mm= *mm= (uint8_t) movie_sample ( *mm );
+  _time.hh= *hh= (uint8_t) movie_sample ( *hh );
+  _time.day_week= *day_week= (uint8_t) movie_sample ( *day_week );
+  _time.day_month= *day_month= (uint8_t) movie_sample ( *day_month );
+  _time.month= *month= (uint8_t) movie_sample ( *month );
+  _time.year= *year= (int) (int32_t) movie_sample ( (uint32_t) *year );
+  _time_set= true;
+  
 } // end get_current_time
 
 
@@ -350,7 +379,7 @@ check_signals (
         
       case SDL_WINDOWEVENT:
         if ( event.window.event == SDL_WINDOWEVENT_FOCUS_LOST )
-          PC_kbd_clear ();
+          replay_input ( REPLAY_EV_KBD_CLEAR, 0, 0 );
         break;
         
       case SDL_QUIT:
@@ -374,6 +403,9 @@ check_signals (
               case SDLK_RETURN:
                 *stop= true;
                 return;
+              case SDLK_t:
+                frontend_set_turbo ( !_turbo );
+                break;
               default: break;
               }
             break;
@@ -383,9 +415,9 @@ check_signals (
             key= get_scancode ( &event );
             if ( key != PC_SCANCODE_ALL )
               {
-                PC_kbd_press ( key );
+                replay_input ( REPLAY_EV_KBD_PRESS, key, 0 );
                 if ( key == PC_KBDSP_BLOQ_MAYUS )
-                  PC_kbd_release ( key );
+                  replay_input ( REPLAY_EV_KBD_RELEASE, key, 0 );
               }
             else fprintf(stderr,"KEY_DOWN key:%d mod:%d\n",
                          event.key.keysym.sym,
@@ -398,8 +430,8 @@ check_signals (
         if ( key != PC_SCANCODE_ALL )
           {
             if ( key == PC_KBDSP_BLOQ_MAYUS )
-              PC_kbd_press ( key );
-            PC_kbd_release ( key );
+              replay_input ( REPLAY_EV_KBD_PRESS, key, 0 );
+            replay_input ( REPLAY_EV_KBD_RELEASE, key, 0 );
           }
         else fprintf(stderr,"KEY_UP key:%d mod:%d\n",
                      event.key.keysym.sym,
@@ -407,21 +439,24 @@ check_signals (
         break;
 
       case SDL_MOUSEMOTION:
-        PC_mouse_motion ( (int32_t) event.motion.xrel,
-                          (int32_t) event.motion.yrel );
+        replay_input ( REPLAY_EV_MOUSE_MOTION,
+                       event.motion.xrel, event.motion.yrel );
         break;
 
       case SDL_MOUSEBUTTONUP:
         switch ( event.button.button )
           {
           case SDL_BUTTON_LEFT:
-            PC_mouse_button_release ( PC_MOUSE_BUTTON_LEFT );
+            replay_input ( REPLAY_EV_MOUSE_RELEASE,
+                           PC_MOUSE_BUTTON_LEFT, 0 );
             break;
           case SDL_BUTTON_MIDDLE:
-            PC_mouse_button_release ( PC_MOUSE_BUTTON_MIDDLE );
+            replay_input ( REPLAY_EV_MOUSE_RELEASE,
+                           PC_MOUSE_BUTTON_MIDDLE, 0 );
             break;
           case SDL_BUTTON_RIGHT:
-            PC_mouse_button_release ( PC_MOUSE_BUTTON_RIGHT );
+            replay_input ( REPLAY_EV_MOUSE_RELEASE,
+                           PC_MOUSE_BUTTON_RIGHT, 0 );
             break;
           }
         break;
@@ -430,13 +465,16 @@ check_signals (
         switch ( event.button.button )
           {
           case SDL_BUTTON_LEFT:
-            PC_mouse_button_press ( PC_MOUSE_BUTTON_LEFT );
+            replay_input ( REPLAY_EV_MOUSE_PRESS,
+                           PC_MOUSE_BUTTON_LEFT, 0 );
             break;
           case SDL_BUTTON_MIDDLE:
-            PC_mouse_button_press ( PC_MOUSE_BUTTON_MIDDLE );
+            replay_input ( REPLAY_EV_MOUSE_PRESS,
+                           PC_MOUSE_BUTTON_MIDDLE, 0 );
             break;
           case SDL_BUTTON_RIGHT:
-            PC_mouse_button_press ( PC_MOUSE_BUTTON_RIGHT );
+            replay_input ( REPLAY_EV_MOUSE_PRESS,
+                           PC_MOUSE_BUTTON_RIGHT, 0 );
             break;
           }
         break;
@@ -456,6 +494,7 @@ reset_sim (void)
 
   
   // En realitat reinicie.
+  movie_sample ( REPLAY_EV_RESET );
   PC_close ();
   PC_init ( _bios, _bios_size, _ide_devices,
             &_frontend, NULL, &_config );
@@ -469,36 +508,47 @@ static void
 loop (void)
 {
 
-  const gint64 SLEEP= 1000;
+  const gint64 SLEEP= USECSTOCHECK;
   const gint64 MIN_DELAY= -10000;
 
-  int cc,cc_iter;
+  int cc_iter;
   gint64 t0,tf,delay;
+  int64_t ts;
   bool stop,reset;
 
 
   screen_enable_cursor ( true );
+  frametime_restart ();
   stop= reset= false;
   t0= g_get_monotonic_time ();
   cc_iter= (int) ((PC_ClockFreq/1000000.0)*SLEEP + 0.5);
-  cc= 0;
   delay= 0;
   for (;;)
     {
 
-      // Executa.
-      cc+= cc_iter;
-      while ( cc > 0 )
-        cc-= PC_jit_iter ( cc );
+      // Executa. En la pel·lícula l'entrada rebuda des del tros
+      // anterior acaba just abans de cada tros.
+      movie_sample ( REPLAY_EV_END );
+      _cc+= cc_iter;
+      while ( _cc > 0 )
+        _cc-= PC_jit_iter ( _cc );
       check_signals ( &stop, &reset );
       if ( stop ) return;
       else if ( reset ) reset_sim ();
       
       // Delay
       tf= g_get_monotonic_time ();
-      delay+= SLEEP-(tf-t0); t0= tf;
-      if ( delay >= SLEEP ) g_usleep ( SLEEP );
+      if ( _turbo ) delay= 0;
+      else          delay+= SLEEP-(tf-t0);
+      t0= tf;
+      if ( delay >= SLEEP )
+        {
+          ts= frametime_begin ();
+          g_usleep ( SLEEP );
+          frametime_end ( FRAMETIME_SLEEP, ts );
+        }
       else if ( delay < MIN_DELAY ) delay= MIN_DELAY;
+      metrics_loop ( SLEEP, delay == MIN_DELAY );
       
     }
   
@@ -541,6 +591,8 @@ close_frontend (void)
   PC_cdrom_free ( _ide_devices[1][0].cdrom.cdrom );
   close_cmos ();
   close_t8biso ();
+  close_tiles16b ();
+  close_tiles8b ();
   close_sound ();
   close_screen ();
   SDL_Quit ();
@@ -626,16 +678,23 @@ frontend_run (
       if ( !frontend_set_disc ( disc_B, DISC_B_FLOPPY_1M2 ) )
         warning ( "no s'ha pogut inserir el disc '%s'", disc_B );
     }
+  _cc= 0;
+  if ( movie_record_waiting () )
+    replay_start_record ( _bios, _bios_size,
+                          _config.pci_devs[0].optrom,
+                          _config.pci_devs[0].optrom_size,
+                          _time_set ? &_time : NULL );
   
   // Executa loop.
   for (;;)
     {
-      PC_kbd_clear ();
+      replay_input ( REPLAY_EV_KBD_CLEAR, 0, 0 );
       screen_grab_cursor ( true );
       loop ();
       screen_grab_cursor ( false );
       if ( _quit ) { ret= MENU_QUIT; break; }
       ret= menu_run ();
+      screen_invalidate ();
       if ( ret == MENU_RESET ) _reset= TRUE;
       else if ( ret != MENU_RESUME ) break;
     }
@@ -724,6 +783,7 @@ frontend_set_disc (
   PC_Error err_ret;
 
   
+  movie_stop_record ( "s'ha canviat un disc" );
   ok= false;
   switch ( type )
     {
@@ -819,6 +879,7 @@ frontend_change_bios (
 
   _bios= bios;
   _bios_size= bios_size;
+  movie_stop_record ( "s'ha canviat la BIOS" );
   reset_sim ();
   
 } // end frontend_change_bios
@@ -833,6 +894,7 @@ frontend_change_vgabios (
 
   _config.pci_devs[0].optrom= bios;
   _config.pci_devs[0].optrom_size= bios_size;
+  movie_stop_record ( "s'ha canviat la VGA BIOS" );
   reset_sim ();
   
 } // end frontend_change_vgabios
@@ -845,6 +907,36 @@ frontend_change_hdd (
 {
 
   _ide_devices[0][0].hdd.f= hdd;
+  movie_stop_record ( "s'ha canviat el disc dur" );
   reset_sim ();
   
 } // end frontend_change_hdd
+
+
+void
+frontend_set_turbo (
+                    const bool enabled
+                    )
+{
+
+  _turbo= enabled;
+  screen_set_turbo ( enabled );
+  sound_set_turbo ( enabled );
+  if ( _verbose )
+    fprintf ( stderr, "Mode turbo: %s\n", enabled ? "sí" : "no" );
+  
+} // end frontend_set_turbo
+
+
+bool
+frontend_get_turbo (void)
+{
+  return _turbo;
+} // end frontend_get_turbo
+
+
+const PC_Config *
+frontend_get_pc_config (void)
+{
+  return &_config;
+} // end frontend_get_pc_config
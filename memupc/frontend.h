@@ -80,6 +80,19 @@ frontend_change_hdd (
                      PC_File *hdd
                      );
 
+// Mode turbo: executa sense limitar la velocitat al temps real.
+void
+frontend_set_turbo (
+                    const bool enabled
+                    );
+
+bool
+frontend_get_turbo (void);
+
+// Configuració del PC que s'empra per a inicialitzar el simulador.
+const PC_Config *
+frontend_get_pc_config (void);
+
 void
 init_frontend (
                conf_t     *conf,
@@ -22,12 +22,24 @@
  */
 
 
+#define _GNU_SOURCE // memfd_create
+
 #include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <glib.h>
 #include <stdint.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/file.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#endif
 
 #include "error.h"
 #include "fchooser.h"
@@ -39,12 +51,39 @@
 
 
 
+/**********/
+/* MACROS */
+/**********/
+
+#define COPY_BLOCK (64*1024)
+
+// Sufix de les còpies de treball que encara no estan bloquejades.
+#define TMP_SUFFIX ".new"
+
+
+
+
 /*********/
 /* ESTAT */
 /*********/
 
 static PC_File *_hdd= NULL;
 
+// Mode instantània. El simulador treballa sobre una còpia temporal
+// del disc dur ('_snap.tmp_fn') i el fitxer original ('_snap.base_fn')
+// no es modifica fins que no es desen els canvis. En HDD_SNAPSHOT_FILE
+// 'fd' manté un flock sobre la còpia, perquè altres instàncies
+// sàpien que no està abandonada. En HDD_SNAPSHOT_RAM és el memfd.
+static struct
+{
+  
+  int    mode;
+  gchar *base_fn;
+  gchar *tmp_fn;
+  int    fd;
+  
+} _snap= { HDD_SNAPSHOT_NONE, NULL, NULL, -1 };
+
 
 
 
@@ -52,6 +91,341 @@ static PC_File *_hdd= NULL;
 /* FUNCIONS PRIVADES */
 /*********************/
 
+static bool
+is_zero (
+         const uint8_t *buf,
+         const ssize_t  n
+         )
+{
+
+  ssize_t i;
+
+
+  for ( i= 0; i < n; ++i )
+    if ( buf[i] != 0 ) return false;
+
+  return true;
+  
+} // end is_zero
+
+
+// Copia el contingut de 'src' en 'dst'. Primer intenta compartir els
+// blocs (FICLONE), que en sistemes de fitxers amb suport de
+// copy-on-write (btrfs, xfs...) és instantani i no ocupa espai. Si
+// no, copia bloc a bloc deixant forats en els blocs a zero.
+static bool
+copy_fd (
+         const int  src,
+         const int  dst,
+         const char *src_fn
+         )
+{
+
+  static uint8_t buf[COPY_BLOCK];
+  
+  ssize_t n;
+  off_t size;
+  
+
+#ifdef FICLONE
+  if ( ioctl ( dst, FICLONE, src ) == 0 ) return true;
+#endif
+  size= 0;
+  while ( (n= read ( src, buf, COPY_BLOCK )) > 0 )
+    {
+      if ( is_zero ( buf, n ) )
+        {
+          if ( lseek ( dst, n, SEEK_CUR ) == -1 ) goto error;
+        }
+      else if ( write ( dst, buf, n ) != n ) goto error;
+      size+= n;
+    }
+  if ( n == -1 ) goto error;
+  if ( ftruncate ( dst, size ) == -1 ) goto error;
+  
+  return true;
+
+ error:
+  warning ( "no s'ha pogut copiar '%s': %s", src_fn, strerror ( errno ) );
+  return false;
+  
+} // end copy_fd
+
+
+static bool
+copy_fn_to_fd (
+               const char *src_fn,
+               const int   dst
+               )
+{
+
+  int src;
+  bool ret;
+  
+
+  src= open ( src_fn, O_RDONLY );
+  if ( src == -1 )
+    {
+      warning ( "no s'ha pogut obrir '%s': %s", src_fn, strerror ( errno ) );
+      return false;
+    }
+  ret= copy_fd ( src, dst, src_fn );
+  close ( src );
+  
+  return ret;
+  
+} // end copy_fn_to_fd
+
+
+// Dóna al fitxer 'tmp_fn' (acabat en TMP_SUFFIX) el nom sense el
+// sufix. S'empra link perquè no xafe cap fitxer amb eixe nom. Torna
+// el nom nou o NULL si falla, i aleshores 'tmp_fn' no s'esborra.
+static gchar *
+publish_tmp (
+             const char *tmp_fn
+             )
+{
+
+  gchar *ret;
+  
+
+  ret= g_strndup ( tmp_fn, strlen ( tmp_fn ) - strlen ( TMP_SUFFIX ) );
+  if ( link ( tmp_fn, ret ) != 0 )
+    {
+      warning ( "no s'ha pogut crear '%s': %s", ret, strerror ( errno ) );
+      g_free ( ret );
+      return NULL;
+    }
+  unlink ( tmp_fn );
+  
+  return ret;
+  
+} // end publish_tmp
+
+
+// Crea un fitxer temporal a partir de 'tmpl' (acabat en XXXXXX) amb
+// el contingut de 'src_fn'. Torna el nom o NULL si falla. Si 'lock'
+// no és NULL el fitxer es queda obert i bloquejat, i en 'lock' es
+// torna el descriptor. En eixe cas el fitxer es crea primer amb
+// TMP_SUFFIX, que snapshot_sweep no esborra, i sols pren el nom
+// definitiu quan ja està bloquejat.
+static gchar *
+copy_to_tmp (
+             const char *src_fn,
+             const char *tmpl,
+             int        *lock
+             )
+{
+
+  gchar *ret,*fn;
+  int dst;
+  bool ok;
+  
+
+  ret= lock == NULL ?
+    g_strdup ( tmpl ) : g_strdup_printf ( "%s%s", tmpl, TMP_SUFFIX );
+  dst= g_mkstemp ( ret );
+  if ( dst == -1 )
+    {
+      warning ( "no s'ha pogut crear '%s': %s", ret, strerror ( errno ) );
+      g_free ( ret );
+      return NULL;
+    }
+  ok= lock == NULL || flock ( dst, LOCK_EX ) == 0;
+  if ( ok && lock != NULL )
+    {
+      fn= publish_tmp ( ret );
+      ok= fn != NULL;
+      if ( ok )
+        {
+          g_free ( ret );
+          ret= fn;
+        }
+    }
+  if ( ok ) ok= copy_fn_to_fd ( src_fn, dst );
+  if ( ok && lock != NULL ) *lock= dst;
+  else if ( close ( dst ) != 0 ) ok= false;
+  if ( !ok )
+    {
+      unlink ( ret );
+      g_free ( ret );
+      ret= NULL;
+    }
+  
+  return ret;
+  
+} // end copy_to_tmp
+
+
+// Esborra de 'dir' les còpies de treball de 'base' que han quedat
+// abandonades (per exemple perquè el programa ha mort). Les que
+// estan en ús tenen un flock. Les acabades en TMP_SUFFIX encara no
+// el tenen i no es toquen.
+static void
+snapshot_sweep (
+                const char *dir,
+                const char *base
+                )
+{
+
+  GDir *d;
+  const gchar *name;
+  gchar *prefix,*fn;
+  int fd;
+  
+
+  d= g_dir_open ( dir, 0, NULL );
+  if ( d == NULL ) return;
+  prefix= g_strdup_printf ( "%s.snapshot-", base );
+  while ( (name= g_dir_read_name ( d )) != NULL )
+    {
+      if ( !g_str_has_prefix ( name, prefix ) ||
+           g_str_has_suffix ( name, TMP_SUFFIX ) )
+        continue;
+      fn= g_build_filename ( dir, name, NULL );
+      fd= open ( fn, O_RDONLY );
+      if ( fd != -1 )
+        {
+          if ( flock ( fd, LOCK_EX|LOCK_NB ) == 0 )
+            {
+              warning ( "s'esborra la còpia abandonada '%s'", fn );
+              unlink ( fn );
+            }
+          close ( fd );
+        }
+      g_free ( fn );
+    }
+  g_free ( prefix );
+  g_dir_close ( d );
+  
+} // end snapshot_sweep
+
+
+// Crea la còpia de treball de 'fn' en fitxer. S'intenta crear al
+// costat de l'original perquè FICLONE sols funciona dins del mateix
+// sistema de fitxers, i si no es pot en el directori temporal.
+static gchar *
+snapshot_create_file (
+                      const char *fn,
+                      int        *fd
+                      )
+{
+
+  gchar *tmpl,*dir,*base,*ret;
+  
+
+  dir= g_path_get_dirname ( fn );
+  base= g_path_get_basename ( fn );
+  snapshot_sweep ( dir, base );
+  snapshot_sweep ( g_get_tmp_dir (), base );
+  tmpl= g_strdup_printf ( "%s.snapshot-XXXXXX", fn );
+  ret= copy_to_tmp ( fn, tmpl, fd );
+  g_free ( tmpl );
+  if ( ret == NULL )
+    {
+      tmpl= g_strdup_printf ( "%s%c%s.snapshot-XXXXXX",
+                              g_get_tmp_dir (), G_DIR_SEPARATOR, base );
+      ret= copy_to_tmp ( fn, tmpl, fd );
+      g_free ( tmpl );
+    }
+  g_free ( base );
+  g_free ( dir );
+  
+  return ret;
+  
+} // end snapshot_create_file
+
+
+// Crea la còpia de treball de 'fn' en memòria (memfd). El nom que es
+// torna és el del descriptor en /proc, que sols és vàlid mentre 'fd'
+// estiga obert.
+static gchar *
+snapshot_create_ram (
+                     const char *fn,
+                     int        *fd
+                     )
+{
+
+#ifdef MFD_CLOEXEC
+  *fd= memfd_create ( "memupc-hdd", MFD_CLOEXEC );
+  if ( *fd == -1 )
+    {
+      warning ( "no s'ha pogut crear la còpia en memòria: %s",
+                strerror ( errno ) );
+      return NULL;
+    }
+  if ( !copy_fn_to_fd ( fn, *fd ) )
+    {
+      close ( *fd );
+      *fd= -1;
+      return NULL;
+    }
+  
+  return g_strdup_printf ( "/proc/self/fd/%d", *fd );
+#else
+  warning ( "la còpia en memòria no està suportada en aquest sistema" );
+  return NULL;
+#endif
+  
+} // end snapshot_create_ram
+
+
+static gchar *
+snapshot_create (
+                 const char *fn,
+                 int        *fd
+                 )
+{
+  return _snap.mode == HDD_SNAPSHOT_RAM ?
+    snapshot_create_ram ( fn, fd ) : snapshot_create_file ( fn, fd );
+} // end snapshot_create
+
+
+// Allibera una còpia de treball.
+static void
+snapshot_release (
+                  gchar     *tmp_fn,
+                  const int  fd
+                  )
+{
+
+  if ( _snap.mode == HDD_SNAPSHOT_FILE ) unlink ( tmp_fn );
+  g_free ( tmp_fn );
+  if ( fd != -1 ) close ( fd );
+  
+} // end snapshot_release
+
+
+static void
+snapshot_free (void)
+{
+
+  if ( _snap.tmp_fn != NULL )
+    {
+      snapshot_release ( _snap.tmp_fn, _snap.fd );
+      _snap.tmp_fn= NULL;
+      _snap.fd= -1;
+    }
+  if ( _snap.base_fn != NULL )
+    {
+      g_free ( _snap.base_fn );
+      _snap.base_fn= NULL;
+    }
+  
+} // end snapshot_free
+
+
+// Si el programa acaba amb error() no es crida a free_hdd.
+static void
+snapshot_atexit (void)
+{
+  
+  if ( _snap.mode == HDD_SNAPSHOT_FILE && _snap.tmp_fn != NULL )
+    unlink ( _snap.tmp_fn );
+  
+} // end snapshot_atexit
+
+
 static PC_File *
 load_hdd_fn (
              const char *fn,
@@ -66,13 +440,51 @@ load_hdd_fn (
     fprintf ( stderr, "S'està montant el disc dur en '%s'\n", fn );
 
   free_hdd ();
+  if ( _snap.mode != HDD_SNAPSHOT_NONE )
+    {
+      _snap.tmp_fn= snapshot_create ( fn, &_snap.fd );
+      if ( _snap.tmp_fn == NULL ) return NULL;
+      _snap.base_fn= g_strdup ( fn );
+      if ( verbose )
+        fprintf ( stderr, "Els canvis es fan sobre la còpia '%s'\n",
+                  _snap.tmp_fn );
+      fn= _snap.tmp_fn;
+    }
   ret= _hdd= PC_file_new_from_file ( fn, false );
+  if ( ret == NULL ) snapshot_free ();
   
   return ret;
   
 } // end load_hdd_fn
 
 
+// Obri 'fn' i el passa al simulador, que es reinicia. El disc
+// anterior es tanca després, quan el simulador ja no l'empra. Torna
+// fals si no s'ha pogut obrir 'fn', i aleshores no canvia res.
+static bool
+snapshot_swap (
+               const char *fn
+               )
+{
+
+  PC_File *hdd;
+  
+
+  hdd= PC_file_new_from_file ( fn, false );
+  if ( hdd == NULL )
+    {
+      warning ( "no s'ha pogut obrir '%s'", fn );
+      return false;
+    }
+  frontend_change_hdd ( hdd );
+  PC_file_free ( _hdd );
+  _hdd= hdd;
+  
+  return true;
+  
+} // end snapshot_swap
+
+
 
 
 /**********************/
@@ -134,6 +546,16 @@ load_hdd (
 } // end load_hdd
 
 
+PC_File *
+load_hdd_file (
+               const char *fn,
+               const int   verbose
+               )
+{
+  return load_hdd_fn ( fn, verbose );
+} // end load_hdd_file
+
+
 bool
 change_hdd (
             conf_t    *conf,
@@ -192,6 +614,7 @@ free_hdd (void)
       PC_file_free ( _hdd );
       _hdd= NULL;
     }
+  snapshot_free ();
   
 } // end free_hdd
 
@@ -206,3 +629,101 @@ remove_hdd (
   conf_set_hdd_fn ( conf, NULL );
   
 } // end remove_hdd
+
+
+void
+hdd_set_snapshot (
+                  const int mode
+                  )
+{
+
+  static bool registered= false;
+
+  
+  _snap.mode= mode;
+  if ( mode != HDD_SNAPSHOT_NONE && !registered )
+    {
+      atexit ( snapshot_atexit );
+      registered= true;
+    }
+  
+} // end hdd_set_snapshot
+
+
+bool
+hdd_snapshot_mounted (void)
+{
+  return _snap.mode != HDD_SNAPSHOT_NONE &&
+    _hdd != NULL && _snap.tmp_fn != NULL;
+} // end hdd_snapshot_mounted
+
+
+bool
+hdd_snapshot_commit (void)
+{
+
+  gchar *tmpl,*fn;
+  bool ret;
+  struct stat st;
+  
+
+  if ( !hdd_snapshot_mounted () ) return false;
+
+  // Canvia el disc per un descriptor nou de la mateixa còpia, així en
+  // tancar l'antic tot queda escrit. La còpia es fa sobre un fitxer
+  // nou que després substitueix l'original, així si falla l'original
+  // no es toca.
+  if ( !snapshot_swap ( _snap.tmp_fn ) ) return false;
+  tmpl= g_strdup_printf ( "%s.commit-XXXXXX", _snap.base_fn );
+  fn= copy_to_tmp ( _snap.tmp_fn, tmpl, NULL );
+  g_free ( tmpl );
+  ret= false;
+  if ( fn != NULL )
+    {
+      if ( stat ( _snap.base_fn, &st ) == 0 )
+        chmod ( fn, st.st_mode&07777 );
+      if ( rename ( fn, _snap.base_fn ) != 0 )
+        {
+          warning ( "no s'ha pogut substituir '%s': %s",
+                    _snap.base_fn, strerror ( errno ) );
+          unlink ( fn );
+        }
+      else ret= true;
+      g_free ( fn );
+    }
+  
+  return ret;
+  
+} // end hdd_snapshot_commit
+
+
+bool
+hdd_snapshot_discard (void)
+{
+
+  gchar *fn;
+  int fd;
+  
+
+  if ( !hdd_snapshot_mounted () ) return false;
+
+  fd= -1;
+  fn= snapshot_create ( _snap.base_fn, &fd );
+  if ( fn != NULL && !snapshot_swap ( fn ) )
+    {
+      snapshot_release ( fn, fd );
+      fn= NULL;
+    }
+  if ( fn == NULL )
+    {
+      warning ( "no s'ha pogut descartar els canvis en '%s'",
+                _snap.base_fn );
+      return false;
+    }
+  snapshot_release ( _snap.tmp_fn, _snap.fd );
+  _snap.tmp_fn= fn;
+  _snap.fd= fd;
+  
+  return true;
+  
+} // end hdd_snapshot_discard
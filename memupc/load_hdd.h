@@ -44,6 +44,14 @@ load_hdd (
           const int  verbose
           );
 
+// Com 'load_hdd' però sense interfície: munta 'fn' respectant el mode
+// instantània, o torna NULL si no s'ha pogut.
+PC_File *
+load_hdd_file (
+               const char *fn,
+               const int   verbose
+               );
+
 // Aquesta funció sols es pot cridar una vegada inicialitzar el
 // frontend. La funció reinicia el simulador després de canviar el
 // disc dur. Torna cert si ha modificat el disc dur, fals en cas
@@ -65,4 +73,43 @@ remove_hdd (
             conf_t *conf
             );
 
+// Mode instantània: el disc dur es munta sobre una còpia de treball
+// que es descarta en tancar.
+//
+//  - HDD_SNAPSHOT_FILE: la còpia és un fitxer al costat de
+//    l'original. Si el sistema de fitxers permet compartir blocs
+//    (btrfs, xfs...) crear-la és instantani, si no es copia tot el
+//    disc en cada arrancada i cada vegada que es descarten els canvis.
+//  - HDD_SNAPSHOT_RAM: la còpia està en memòria. Sempre es copia tot
+//    el disc i ocupa tanta memòria com dades té.
+enum
+  {
+   HDD_SNAPSHOT_NONE= 0,
+   HDD_SNAPSHOT_FILE,
+   HDD_SNAPSHOT_RAM
+  };
+
+// Cal cridar-ho abans de 'load_hdd'.
+void
+hdd_set_snapshot (
+                  const int mode
+                  );
+
+// Torna cert si hi ha un disc dur muntat en mode instantània.
+bool
+hdd_snapshot_mounted (void);
+
+// Escriu en el disc original els canvis de la còpia. Abans reinicia
+// el simulador amb un descriptor nou de la còpia perquè tot estiga
+// escrit. Torna cert si s'han desat, fals si no o si no hi ha cap
+// disc muntat en mode instantània.
+bool
+hdd_snapshot_commit (void);
+
+// Torna la còpia a l'estat del disc original i reinicia el
+// simulador. Torna cert si s'han descartat els canvis, fals si no o
+// si no hi ha cap disc muntat en mode instantània.
+bool
+hdd_snapshot_discard (void);
+
 #endif // __LOAD_HDD_H__
@@ -34,8 +34,14 @@
 #include "conf.h"
 #include "dirs.h"
 #include "error.h"
+#include "framehash.h"
+#include "frametime.h"
 #include "frontend.h"
+#include "load_hdd.h"
 #include "lock.h"
+#include "metrics.h"
+#include "movie.h"
+#include "replay.h"
 #include "session.h"
 
 #include "PC.h"
@@ -47,7 +53,7 @@
 /* MACROS */
 /**********/
 
-#define NUM_ARGS 0
+#define NUM_ARGS 1
 
 
 
@@ -56,6 +62,13 @@
 /* TIPUS */
 /*********/
 
+struct args
+{
+
+  const gchar *hdd_fn;
+  
+};
+
 struct opts
 {
   
@@ -66,6 +79,16 @@ struct opts
   gchar    *disc_D;
   gchar    *disc_A;
   gchar    *disc_B;
+  gchar    *frame_csv_fn;
+  gchar    *metrics_fn;
+  gboolean  snapshot;
+  gboolean  snapshot_ram;
+  gchar    *record_fn;
+  gchar    *replay_fn;
+  gint      frames;
+  gchar    *golden_fn;
+  gboolean  write_golden;
+  gint      hash_period;
   
 };
 
@@ -80,6 +103,7 @@ static void
 usage (
        int          *argc,
        char        **argv[],
+       struct args  *args,
        struct opts  *opts
        )
 {
@@ -92,7 +116,17 @@ usage (
      NULL,     // title
      NULL,     // disc_D
      NULL,     // disc_A
-     NULL      // disc_B
+     NULL,     // disc_B
+     NULL,     // frame_csv_fn
+     NULL,     // metrics_fn
+     FALSE,    // snapshot
+     FALSE,    // snapshot_ram
+     NULL,     // record_fn
+     NULL,     // replay_fn
+     0,        // frames
+     NULL,     // golden_fn
+     FALSE,    // write_golden
+     60        // hash_period
     };
   
   static GOptionEntry entries[]=
@@ -109,6 +143,45 @@ usage (
       { "conf", 'c', 0, G_OPTION_ARG_STRING, &vals.conf_fn,
         "Empra com a fitxer de configuració CONF",
         "CONF" },
+      { "frame-csv", 0, 0, G_OPTION_ARG_STRING, &vals.frame_csv_fn,
+        "Escriu en CSV el temps (en microsegons) que es gasta en cada"
+        " etapa de cada fotograma",
+        "CSV" },
+      { "metrics", 0, 0, G_OPTION_ARG_STRING, &vals.metrics_fn,
+        "Serveix mètriques en format de Prometheus en el socket UNIX SOCKET",
+        "SOCKET" },
+      { "record", 0, 0, G_OPTION_ARG_STRING, &vals.record_fn,
+        "Grava en MOVIE l'entrada del teclat i el ratolí des de l'encesa."
+        " Necessita --snapshot o --snapshot-ram",
+        "MOVIE" },
+      { "replay", 0, 0, G_OPTION_ARG_STRING, &vals.replay_fn,
+        "Reprodueix MOVIE sobre el disc dur HDD sense finestra ni so, tan"
+        " ràpid com es puga, i imprimeix estadístiques",
+        "MOVIE" },
+      { "frames", 0, 0, G_OPTION_ARG_INT, &vals.frames,
+        "Amb --replay, para després de N fotogrames",
+        "N" },
+      { "golden", 0, 0, G_OPTION_ARG_STRING, &vals.golden_fn,
+        "Amb --replay, compara els hashos de la imatge i el so amb els"
+        " de GOLDEN i acaba amb error si no coincideixen",
+        "GOLDEN" },
+      { "write-golden", 0, 0, G_OPTION_ARG_NONE, &vals.write_golden,
+        "Amb --golden, escriu GOLDEN en compte de comparar",
+        NULL },
+      { "hash-period", 0, 0, G_OPTION_ARG_INT, &vals.hash_period,
+        "Amb --golden, calcula un hash cada N fotogrames (60 per defecte)",
+        "N" },
+      { "snapshot", 's', 0, G_OPTION_ARG_NONE, &vals.snapshot,
+        "Munta el disc dur sobre una còpia temporal al costat de"
+        " l'original. Els canvis es descarten en eixir si no es desen"
+        " des del menú. Sols és instantani en sistemes de fitxers que"
+        " comparteixen blocs (btrfs, xfs...), en la resta es copia tot"
+        " el disc en arrancar i en descartar els canvis",
+        NULL },
+      { "snapshot-ram", 0, 0, G_OPTION_ARG_NONE, &vals.snapshot_ram,
+        "Com --snapshot però amb la còpia en memòria. Sempre es copia"
+        " tot el disc",
+        NULL },
       { "title", 't', 0, G_OPTION_ARG_STRING, &vals.title,
         "Fixa el nom de la finestra (sols amb ROM)",
         "TITLE" },
@@ -130,13 +203,14 @@ usage (
   // Paresja opcions i obté valors.
   err= NULL;
   context= g_option_context_new
-    ( "executa simulador d'un Pentium PC" );
+    ( "[<hdd>] - executa simulador d'un Pentium PC" );
   g_option_context_set_description
     ( context,
       "Dreceres de teclat:\n"
       "\n"
       "  * Eixir: L.Ctrl + L.Gui + Q\n"
       "  * Menú: L.Ctrl + L.Gui + (RETORN|ESCAPE)\n"
+      "  * Mode turbo: L.Ctrl + L.Gui + T\n"
       );
   g_option_context_add_main_entries ( context, entries, NULL );
   if ( !g_option_context_parse ( context, argc, argv, &err ) )
@@ -144,9 +218,27 @@ usage (
   g_option_context_free ( context );
   *opts= vals;
   
-  // Comprova arguments.
-  if ( *argc-1 != NUM_ARGS )
+  // Comprova arguments. El disc dur sols es passa per a reproduir,
+  // en la resta de casos ve del fitxer de configuració.
+  args->hdd_fn= NULL;
+  if ( *argc-1 > NUM_ARGS )
     error ( "número d'arguments incorrecte" );
+  else if ( *argc-1 == 1 )
+    args->hdd_fn= (*argv)[1];
+  if ( (opts->replay_fn != NULL) != (args->hdd_fn != NULL) )
+    error ( "el disc dur sols es pot indicar, i s'ha d'indicar,"
+            " amb --replay" );
+  if ( opts->snapshot && opts->snapshot_ram )
+    error ( "--snapshot i --snapshot-ram són incompatibles" );
+  if ( opts->record_fn != NULL && opts->replay_fn != NULL )
+    error ( "no es pot gravar i reproduir al mateix temps" );
+  if ( opts->record_fn != NULL && !opts->snapshot && !opts->snapshot_ram )
+    error ( "--record necessita --snapshot o --snapshot-ram: el disc dur"
+            " ha de quedar com estava en començar" );
+  if ( opts->golden_fn != NULL && opts->replay_fn == NULL )
+    error ( "--golden sols es pot emprar amb --replay" );
+  if ( opts->frames < 0 || opts->hash_period <= 0 )
+    error ( "el nombre de fotogrames no és vàlid" );
   
 } // end usage
 
@@ -162,6 +254,11 @@ free_opts (
   if ( opts->disc_D != NULL ) g_free ( opts->disc_D );
   if ( opts->session_name != NULL ) g_free ( opts->session_name );
   if ( opts->conf_fn != NULL ) g_free ( opts->conf_fn );
+  if ( opts->frame_csv_fn != NULL ) g_free ( opts->frame_csv_fn );
+  if ( opts->metrics_fn != NULL ) g_free ( opts->metrics_fn );
+  if ( opts->record_fn != NULL ) g_free ( opts->record_fn );
+  if ( opts->replay_fn != NULL ) g_free ( opts->replay_fn );
+  if ( opts->golden_fn != NULL ) g_free ( opts->golden_fn );
   
 } // end free_opts
 
@@ -195,6 +292,41 @@ get_title (
 } // end get_title
 
 
+// Identificador de la pel·lícula.
+static gchar *
+get_movie_id (
+              const gchar *hdd_fn
+              )
+{
+  return hdd_fn!=NULL ? g_path_get_basename ( hdd_fn ) : g_strdup ( "" );
+} // end get_movie_id
+
+
+static void
+run_replay (
+            const struct args *args,
+            const struct opts *opts
+            )
+{
+
+  gchar *id;
+  
+
+  id= get_movie_id ( args->hdd_fn );
+  if ( opts->golden_fn != NULL )
+    init_framehash ( opts->golden_fn, opts->write_golden, opts->hash_period );
+  if ( !init_movie_replay ( opts->replay_fn, "PC", id, opts->verbose ) ||
+       !replay_run ( args->hdd_fn, opts->disc_D, opts->disc_A, opts->disc_B,
+                     opts->frames, opts->verbose ) )
+    error ( "no s'ha pogut reproduir '%s'", opts->replay_fn );
+  close_movie ();
+  g_free ( id );
+  if ( !close_framehash () )
+    error ( "la reproducció no coincideix amb '%s'", opts->golden_fn );
+  
+} // end run_replay
+
+
 static void
 run (
      const struct opts *opts
@@ -202,7 +334,7 @@ run (
 {
   
   conf_t conf;
-  gchar *title;
+  gchar *title, *id;
   
   
   // Inicialitza
@@ -212,11 +344,21 @@ run (
       init_dirs ();
       get_conf ( &conf, opts->conf_fn, opts->verbose );
       title= get_title ( opts->title );
+      hdd_set_snapshot ( opts->snapshot_ram ? HDD_SNAPSHOT_RAM :
+                         (opts->snapshot ? HDD_SNAPSHOT_FILE :
+                          HDD_SNAPSHOT_NONE) );
       init_frontend ( &conf, title, opts->verbose );
       g_free ( title );
       
       // Executa.
+      if ( opts->record_fn != NULL )
+        {
+          id= get_movie_id ( conf.hdd_fn );
+          init_movie_record ( opts->record_fn, "PC", id, opts->verbose );
+          g_free ( id );
+        }
       frontend_run ( opts->disc_D, opts->disc_A, opts->disc_B );
+      close_movie ();
       
       // Allibera memòria i tanca
       close_frontend ();
@@ -239,16 +381,24 @@ run (
 int main ( int argc, char *argv[] )
 {
 
+  struct args args;
   struct opts opts;
   
   
   setlocale ( LC_ALL, "" );
   
   // Parseja línea de comandaments.
-  usage ( &argc, &argv, &opts );
+  usage ( &argc, &argv, &args, &opts );
   
   // Executa.
-  run ( &opts );
+  if ( opts.frame_csv_fn != NULL )
+    init_frametime ( false, opts.frame_csv_fn );
+  if ( opts.metrics_fn != NULL )
+    init_metrics ( opts.metrics_fn, "PC" );
+  if ( opts.replay_fn != NULL ) run_replay ( &args, &opts );
+  else                          run ( &opts );
+  close_metrics ();
+  close_frametime ();
   
   // Despedida.
   free_opts ( &opts );
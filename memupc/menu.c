@@ -536,6 +536,26 @@ change_vsync_action (
 } // end change_vsync_action
 
 
+static const char *
+turbo_get_text (void)
+{
+  return frontend_get_turbo () ? "TURBO: Si" : "TURBO: NO";
+} // end turbo_get_text
+
+
+static int
+turbo_action (
+              menu_state_t *mst
+              )
+{
+
+  frontend_set_turbo ( !frontend_get_turbo () );
+  
+  return CONTINUE;
+  
+} // end turbo_action
+
+
 static const char *
 reset_get_text (void)
 {
@@ -630,6 +650,46 @@ hdd_action (
 } // end hdd_action
 
 
+static const char *
+snapshot_commit_get_text (void)
+{
+  return "DESA CANVIS DEL DISC DUR";
+} // end snapshot_commit_get_text
+
+
+static int
+snapshot_commit_action (
+                        menu_state_t *mst
+                        )
+{
+  // Si cal, el simulador ja s'ha reiniciat.
+  hdd_snapshot_commit ();
+  
+  return CONTINUE;
+  
+} // end snapshot_commit_action
+
+
+static const char *
+snapshot_discard_get_text (void)
+{
+  return "DESCARTA CANVIS DEL DISC DUR";
+} // end snapshot_discard_get_text
+
+
+static int
+snapshot_discard_action (
+                         menu_state_t *mst
+                         )
+{
+  // Si cal, el simulador ja s'ha reiniciat.
+  hdd_snapshot_discard ();
+  
+  return CONTINUE;
+  
+} // end snapshot_discard_action
+
+
 static const char *
 quit_get_text (void)
 {
@@ -695,7 +755,27 @@ menu_run (void)
      {floppyB_get_text,floppyB_action},
      {screen_size_get_text,screen_size_action},
      {change_vsync_get_text,change_vsync_action},
+     {turbo_get_text,turbo_action},
+     {reset_get_text,reset_action},
+     {hdd_get_text,hdd_action},
+     {bios_get_text,bios_action},
+     {vgabios_get_text,vgabios_action},
+     {quit_get_text,quit_action}
+    };
+
+  // Amb el disc dur en mode instantània.
+  static const menuitem_t menu_snapshot[]=
+    {
+     {resume_get_text,resume_action},
+     {cd_get_text,cd_action},
+     {floppyA_get_text,floppyA_action},
+     {floppyB_get_text,floppyB_action},
+     {screen_size_get_text,screen_size_action},
+     {change_vsync_get_text,change_vsync_action},
+     {turbo_get_text,turbo_action},
      {reset_get_text,reset_action},
+     {snapshot_commit_get_text,snapshot_commit_action},
+     {snapshot_discard_get_text,snapshot_discard_action},
      {hdd_get_text,hdd_action},
      {bios_get_text,bios_action},
      {vgabios_get_text,vgabios_action},
@@ -704,19 +784,21 @@ menu_run (void)
   
   static const menumode_t menus[]=
     {
-      { 11, menu_basic },
+      { 12, menu_basic },
+      { 14, menu_snapshot },
     };
   
   const gulong delay1= 200000;
   const gulong delay2= 100000;
 
   menu_state_t mst;
-  int buttons, ret;
+  int buttons, ret, mode;
   gulong delay;
   
 
-  mst.N= menus[0].N;
-  mst.menu= menus[0].items;
+  mode= hdd_snapshot_mounted () ? 1 : 0;
+  mst.N= menus[mode].N;
+  mst.menu= menus[mode].items;
   mst.current= 0;
   mst.mouse_x= 0;
   mst.mouse_y= 0;
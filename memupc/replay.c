@@ -0,0 +1,664 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/memus.
+ *
+ * adriagipas/memus is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/memus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/memus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  replay.c - Implementació de 'replay.h'.
+ *
+ *  No s'inicialitza SDL. La CMOS no es desa i el disc dur és una
+ *  còpia en memòria que es descarta.
+ *
+ */
+
+
+#include <glib.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cmos.h"
+#include "error.h"
+#include "framehash.h"
+#include "frontend.h"
+#include "load_hdd.h"
+#include "movie.h"
+#include "replay.h"
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+// Fotogrames generats i màxim (0 sense límit).
+static unsigned long _frames;
+static unsigned long _max_frames;
+
+// BIOS i VGA BIOS de la pel·lícula.
+static uint8_t *_bios;
+static size_t _bios_size;
+static uint8_t *_vgabios;
+static size_t _vgabios_size;
+
+// CMOS desada i la que està emprant el simulador.
+static uint8_t _cmos0[CMOS_RAM_SIZE];
+static uint8_t _cmos[CMOS_RAM_SIZE];
+
+// Hora de la primera inicialització. Les següents es lligen de la
+// pel·lícula.
+static replay_time_t _time;
+static bool _time_pending;
+
+// Línia del fotograma convertida a RGB.
+static uint8_t *_line;
+static int _line_width;
+
+// Dispositius.
+static PC_Config _config;
+static PC_IDEDevice _ide_devices[2][2];
+static PC_File *_fd[2];
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static void
+_warning (
+          void       *udata,
+          const char *format,
+          ...
+          )
+{
+  
+  va_list ap;
+  
+  
+  va_start ( ap, format );
+  vwarning ( format, ap );
+  va_end ( ap );
+  
+} // end _warning
+
+
+static void
+write_sea_bios_debug_port (
+                           const char  c,
+                           void       *udata
+                           )
+{
+} // end write_sea_bios_debug_port
+
+
+static void
+update_screen (
+               void         *udata,
+               const PC_RGB *fb,
+               const int     width,
+               const int     height,
+               const int     line_stride
+               )
+{
+  
+  int geo[2];
+  int r,c;
+  uint8_t *p;
+  
+  
+  if ( width > _line_width )
+    {
+      _line= g_renew ( uint8_t, _line, width*3 );
+      _line_width= width;
+    }
+  geo[0]= width; geo[1]= height;
+  framehash_video_data ( geo, sizeof(geo) );
+  for ( r= 0; r < height; ++r, fb+= line_stride )
+    {
+      p= _line;
+      for ( c= 0; c < width; ++c )
+        {
+          *(p++)= (uint8_t) fb[c].r;
+          *(p++)= (uint8_t) fb[c].g;
+          *(p++)= (uint8_t) fb[c].b;
+        }
+      framehash_video_data ( _line, width*3 );
+    }
+  framehash_video ( NULL, 0 );
+  ++_frames;
+  
+} // end update_screen
+
+
+static void
+play_sound (
+            const int16_t  samples[PC_AUDIO_BUFFER_SIZE*2],
+            void          *udata
+            )
+{
+  framehash_audio ( samples, sizeof(int16_t)*PC_AUDIO_BUFFER_SIZE*2 );
+} // end play_sound
+
+
+// Cada inicialització rep la CMOS desada, com en el frontend.
+static uint8_t *
+get_cmos_ram (
+              void *udata
+              )
+{
+  
+  memcpy ( _cmos, _cmos0, CMOS_RAM_SIZE );
+  
+  return &_cmos[0];
+  
+} // end get_cmos_ram
+
+
+static void
+get_current_time (
+                  void    *udata,
+                  uint8_t *ss,
+                  uint8_t *mm,
+                  uint8_t *hh,
+                  uint8_t *day_week,
+                  uint8_t *day_month,
+                  uint8_t *month,
+                  int     *year
+                  )
+{
+  
+  if ( _time_pending )
+    {
+      *ss= _time.ss;
+      *mm= _time.mm;
+      *hh= _time.hh;
+      *day_week= _time.day_week;
+      *day_month= _time.day_month;
+      *month= _time.month;
+      *year= _time.year;
+      _time_pending= false;
+    }
+  else
+    {
+      *ss= (uint8_t) movie_sample ( 0 );
+      *mm= (uint8_t) movie_sample ( 0 );
+      *hh= (uint8_t) movie_sample ( 0 );
+      *day_week= (uint8_t) movie_sample ( 0 );
+      *day_month= (uint8_t) movie_sample ( 0 );
+      *month= (uint8_t) movie_sample ( 0 );
+      *year= (int) (int32_t) movie_sample ( 0 );
+    }
+  
+} // end get_current_time
+
+
+static void
+write_u32 (
+           FILE           *f,
+           const uint32_t  val
+           )
+{
+  
+  uint8_t buf[4];
+  
+  
+  buf[0]= (uint8_t) val;
+  buf[1]= (uint8_t) (val>>8);
+  buf[2]= (uint8_t) (val>>16);
+  buf[3]= (uint8_t) (val>>24);
+  fwrite ( buf, 4, 1, f );
+  
+} // end write_u32
+
+
+static bool
+read_u32 (
+          FILE     *f,
+          uint32_t *val
+          )
+{
+  
+  uint8_t buf[4];
+  
+  
+  if ( fread ( buf, 4, 1, f ) != 1 ) return false;
+  *val=
+    ((uint32_t) buf[0]) |
+    (((uint32_t) buf[1])<<8) |
+    (((uint32_t) buf[2])<<16) |
+    (((uint32_t) buf[3])<<24);
+  
+  return true;
+  
+} // end read_u32
+
+
+// Llig un bloc de dades precedit de la seua grandària.
+static uint8_t *
+read_block (
+            FILE   *f,
+            size_t *size
+            )
+{
+  
+  uint32_t tmp;
+  uint8_t *ret;
+  
+  
+  if ( !read_u32 ( f, &tmp ) || tmp == 0 ) return NULL;
+  ret= g_new ( uint8_t, tmp );
+  if ( fread ( ret, tmp, 1, f ) != 1 )
+    {
+      g_free ( ret );
+      return NULL;
+    }
+  *size= (size_t) tmp;
+  
+  return ret;
+  
+} // end read_block
+
+
+// Llig la BIOS, la VGA BIOS, la CMOS i l'hora.
+static bool
+read_state (void)
+{
+  
+  FILE *f;
+  uint8_t buf[7];
+  uint32_t year;
+  
+  
+  f= movie_state_open_read ();
+  if ( f == NULL ) return false;
+  _bios= read_block ( f, &_bios_size );
+  if ( _bios == NULL ) goto error;
+  _vgabios= read_block ( f, &_vgabios_size );
+  if ( _vgabios == NULL ) goto error;
+  if ( fread ( _cmos0, CMOS_RAM_SIZE, 1, f ) != 1 ) goto error;
+  if ( fread ( buf, 7, 1, f ) != 1 || !read_u32 ( f, &year ) ) goto error;
+  _time_pending= buf[0]!=0;
+  _time.ss= buf[1];
+  _time.mm= buf[2];
+  _time.hh= buf[3];
+  _time.day_week= buf[4];
+  _time.day_month= buf[5];
+  _time.month= buf[6];
+  _time.year= (int) (int32_t) year;
+  fclose ( f );
+  
+  return true;
+  
+ error:
+  fclose ( f );
+  return false;
+  
+} // end read_state
+
+
+static void
+send_input (
+            const int type,
+            const int a,
+            const int b
+            )
+{
+  
+  switch ( type )
+    {
+    case REPLAY_EV_KBD_PRESS: PC_kbd_press ( a ); break;
+    case REPLAY_EV_KBD_RELEASE: PC_kbd_release ( a ); break;
+    case REPLAY_EV_KBD_CLEAR: PC_kbd_clear (); break;
+    case REPLAY_EV_MOUSE_MOTION:
+      PC_mouse_motion ( (int32_t) a, (int32_t) b );
+      break;
+    case REPLAY_EV_MOUSE_PRESS: PC_mouse_button_press ( a ); break;
+    case REPLAY_EV_MOUSE_RELEASE: PC_mouse_button_release ( a ); break;
+    default:
+      error ( "send_input - esdeveniment (%d) desconegut", type );
+    }
+  
+} // end send_input
+
+
+static bool
+init_sim (
+          PC_Frontend *frontend
+          )
+{
+  
+  PC_Error err;
+  int i;
+  
+  
+  err= PC_init ( _bios, _bios_size, _ide_devices, frontend, NULL, &_config );
+  if ( err != PC_NOERROR )
+    {
+      warning ( "no s'ha pogut inicialitzar el PC (error %d)", err );
+      return false;
+    }
+  for ( i= 0; i < 2; ++i )
+    PC_fd_insert_floppy ( _fd[i], i );
+  
+  return true;
+  
+} // end init_sim
+
+
+// Aplica els esdeveniments gravats abans del següent tros, fins a
+// REPLAY_EV_END. Torna false si ja s'havia acabat la pel·lícula.
+static bool
+read_input (
+            PC_Frontend *frontend
+            )
+{
+  
+  uint32_t ev;
+  int type,a,b;
+  
+  
+  if ( movie_end () ) return false;
+  while ( (ev= movie_sample ( REPLAY_EV_END )) != REPLAY_EV_END )
+    {
+      type= (int) (ev&((1<<REPLAY_EV_BITS)-1));
+      a= (int) (ev>>REPLAY_EV_BITS);
+      b= 0;
+      if ( type == REPLAY_EV_RESET )
+        {
+          PC_close ();
+          if ( !init_sim ( frontend ) )
+            error ( "no s'ha pogut reiniciar el PC" );
+          continue;
+        }
+      if ( type == REPLAY_EV_MOUSE_MOTION )
+        {
+          a= (int) (int32_t) movie_sample ( 0 );
+          b= (int) (int32_t) movie_sample ( 0 );
+        }
+      send_input ( type, a, b );
+    }
+  
+  return true;
+  
+} // end read_input
+
+
+static PC_File *
+open_floppy (
+             const gchar *fn
+             )
+{
+  
+  PC_File *ret;
+  
+  
+  if ( fn == NULL ) return NULL;
+  ret= PC_file_new_from_file ( fn, true );
+  if ( ret == NULL )
+    warning ( "no s'ha pogut obrir el disquet '%s'", fn );
+  
+  return ret;
+  
+} // end open_floppy
+
+
+static void
+free_devices (void)
+{
+  
+  int i;
+  
+  
+  for ( i= 0; i < 2; ++i )
+    if ( _fd[i] != NULL )
+      {
+        PC_file_free ( _fd[i] );
+        _fd[i]= NULL;
+      }
+  if ( _ide_devices[1][0].cdrom.cdrom != NULL )
+    {
+      PC_cdrom_free ( _ide_devices[1][0].cdrom.cdrom );
+      _ide_devices[1][0].cdrom.cdrom= NULL;
+    }
+  free_hdd ();
+  
+} // end free_devices
+
+
+static bool
+init_devices (
+              const gchar *hdd_fn,
+              const gchar *disc_D,
+              const gchar *disc_A,
+              const gchar *disc_B,
+              const bool   verbose
+              )
+{
+  
+  char *err;
+  
+  
+  // Disc dur sobre una còpia en memòria.
+  hdd_set_snapshot ( HDD_SNAPSHOT_RAM );
+  _ide_devices[0][0].hdd.type= PC_IDE_DEVICE_TYPE_HDD;
+  _ide_devices[0][0].hdd.f= load_hdd_file ( hdd_fn, verbose );
+  if ( _ide_devices[0][0].hdd.f == NULL )
+    {
+      warning ( "no s'ha pogut muntar el disc dur '%s'", hdd_fn );
+      return false;
+    }
+  _ide_devices[0][1].type= PC_IDE_DEVICE_TYPE_NONE;
+  
+  // CD-Rom.
+  _ide_devices[1][0].cdrom.type= PC_IDE_DEVICE_TYPE_CDROM;
+  _ide_devices[1][0].cdrom.cdrom= PC_cdrom_new ();
+  if ( _ide_devices[1][0].cdrom.cdrom == NULL )
+    error ( "no s'ha pogut reservar memòria per al cdrom" );
+  _ide_devices[1][1].type= PC_IDE_DEVICE_TYPE_NONE;
+  if ( disc_D != NULL &&
+       !PC_cdrom_insert_disc ( _ide_devices[1][0].cdrom.cdrom,
+                               disc_D, &err ) )
+    {
+      warning ( "no s'ha pogut insertar '%s' en la unitat D: %s",
+                disc_D, err );
+      free ( err );
+      return false;
+    }
+  
+  // Disquets.
+  _fd[0]= open_floppy ( disc_A );
+  _fd[1]= open_floppy ( disc_B );
+  if ( (disc_A != NULL && _fd[0] == NULL) ||
+       (disc_B != NULL && _fd[1] == NULL) )
+    return false;
+  
+  return true;
+  
+} // end init_devices
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+void
+replay_input (
+              const int type,
+              const int a,
+              const int b
+              )
+{
+  
+  if ( type == REPLAY_EV_MOUSE_MOTION )
+    {
+      movie_sample ( (uint32_t) type );
+      movie_sample ( (uint32_t) (int32_t) a );
+      movie_sample ( (uint32_t) (int32_t) b );
+    }
+  else movie_sample ( ((uint32_t) type) | (((uint32_t) a)<<REPLAY_EV_BITS) );
+  send_input ( type, a, b );
+  
+} // end replay_input
+
+
+bool
+replay_run (
+            const gchar         *hdd_fn,
+            const gchar         *disc_D,
+            const gchar         *disc_A,
+            const gchar         *disc_B,
+            const unsigned long  max_frames,
+            const bool           verbose
+            )
+{
+  
+  PC_Frontend frontend;
+  bool ret;
+  gint64 t0,tf;
+  uint64_t total;
+  int cc,cc_iter,tmp;
+  double secs;
+  
+  
+  // Estat inicial.
+  ret= false;
+  _bios= _vgabios= NULL;
+  _line= NULL;
+  _line_width= 0;
+  memset ( _ide_devices, 0, sizeof(_ide_devices) );
+  _fd[0]= _fd[1]= NULL;
+  if ( !read_state () )
+    {
+      warning ( "la pel·lícula no té un estat inicial vàlid" );
+      goto free_state;
+    }
+  if ( !init_devices ( hdd_fn, disc_D, disc_A, disc_B, verbose ) )
+    goto free_devices;
+  _config= *frontend_get_pc_config ();
+  _config.pci_devs[0].optrom= _vgabios;
+  _config.pci_devs[0].optrom_size= _vgabios_size;
+  
+  // Inicialitza.
+  frontend.warning= _warning;
+  frontend.write_sb_dbg_port= write_sea_bios_debug_port;
+  frontend.update_screen= update_screen;
+  frontend.play_sound= play_sound;
+  frontend.get_cmos_ram= get_cmos_ram;
+  frontend.get_current_time= get_current_time;
+  frontend.trace= NULL;
+  _frames= 0;
+  _max_frames= max_frames;
+  if ( !init_sim ( &frontend ) ) goto free_devices;
+  
+  // Executa.
+  t0= g_get_monotonic_time ();
+  cc_iter= (int) ((PC_ClockFreq/1000000.0)*USECSTOCHECK + 0.5);
+  cc= 0;
+  total= 0;
+  while ( read_input ( &frontend ) &&
+          (_max_frames == 0 || _frames < _max_frames) )
+    {
+      cc+= cc_iter;
+      while ( cc > 0 )
+        {
+          tmp= PC_jit_iter ( cc );
+          cc-= tmp;
+          total+= tmp;
+        }
+    }
+  tf= g_get_monotonic_time ();
+  PC_close ();
+  
+  // Estadístiques.
+  secs= (tf-t0)/1000000.0;
+  printf ( "Mostres:    %lu\n", (unsigned long) movie_get_nsamples () );
+  printf ( "Fotogrames: %lu\n", _frames );
+  printf ( "Cicles:     %lu\n", (unsigned long) total );
+  printf ( "Temps:      %.3f s (%.1f fotogrames/s)\n",
+           secs, secs > 0 ? _frames/secs : 0.0 );
+  if ( verbose )
+    fprintf ( stderr, "Reproducció acabada\n" );
+  ret= true;
+  
+  // Allibera.
+ free_devices:
+  free_devices ();
+ free_state:
+  g_free ( _line );
+  g_free ( _vgabios );
+  g_free ( _bios );
+  
+  return ret;
+  
+} // end replay_run
+
+
+bool
+replay_start_record (
+                     const uint8_t       *bios,
+                     const size_t         bios_size,
+                     const uint8_t       *vgabios,
+                     const size_t         vgabios_size,
+                     const replay_time_t *time
+                     )
+{
+  
+  FILE *f;
+  uint8_t cmos[CMOS_RAM_SIZE];
+  uint8_t buf[7];
+  
+  
+  if ( !movie_record_waiting () ) return false;
+  f= movie_state_open_write ();
+  if ( f == NULL ) return false;
+  write_u32 ( f, (uint32_t) bios_size );
+  fwrite ( bios, bios_size, 1, f );
+  write_u32 ( f, (uint32_t) vgabios_size );
+  fwrite ( vgabios, vgabios_size, 1, f );
+  cmos_get_saved ( cmos );
+  fwrite ( cmos, CMOS_RAM_SIZE, 1, f );
+  memset ( buf, 0, sizeof(buf) );
+  if ( time != NULL )
+    {
+      buf[0]= 1;
+      buf[1]= time->ss;
+      buf[2]= time->mm;
+      buf[3]= time->hh;
+      buf[4]= time->day_week;
+      buf[5]= time->day_month;
+      buf[6]= time->month;
+    }
+  fwrite ( buf, 7, 1, f );
+  write_u32 ( f, time != NULL ? (uint32_t) (int32_t) time->year : 0 );
+  if ( ferror ( f ) )
+    {
+      warning ( "no s'ha pogut desar l'estat inicial de la pel·lícula" );
+      fclose ( f );
+      return false;
+    }
+  
+  return movie_start_record ( NULL, 0, f );
+  
+} // end replay_start_record
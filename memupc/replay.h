@@ -0,0 +1,116 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/memus.
+ *
+ * adriagipas/memus is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/memus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/memus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  replay.h - Reproducció de pel·lícules sense finestra ni so.
+ *
+ *  El PC no té estats. Les pel·lícules sempre comencen en l'encesa,
+ *  i com a estat inicial es desen la BIOS, la VGA BIOS, la CMOS i
+ *  l'hora amb què s'ha inicialitzat el simulador. El disc dur i els
+ *  discs inserits es tornen a passar en la línia de comandaments.
+ *
+ *  L'entrada no la llig el simulador, el frontend l'empeny entre
+ *  dues crides a PC_jit_iter. Per això, abans de cada tros de
+ *  USECSTOCHECK microsegons simulats, es grava la seqüència
+ *  d'esdeveniments rebuts des del tros anterior acabada en
+ *  REPLAY_EV_END.
+ *
+ */
+
+#ifndef __REPLAY_H__
+#define __REPLAY_H__
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "PC.h"
+
+// Microsegons simulats entre dues comprovacions de l'entrada. La
+// reproducció ha d'emprar el mateix valor que la gravació.
+#define USECSTOCHECK 1000
+
+// Esdeveniments gravats. Cada esdeveniment és una mostra amb el
+// tipus en els bits baixos i l'argument en la resta, excepte
+// REPLAY_EV_MOUSE_MOTION que va seguit de dues mostres amb el
+// desplaçament.
+#define REPLAY_EV_BITS 3
+enum
+  {
+   REPLAY_EV_END= 0,
+   REPLAY_EV_KBD_PRESS,
+   REPLAY_EV_KBD_RELEASE,
+   REPLAY_EV_KBD_CLEAR,
+   REPLAY_EV_MOUSE_MOTION,
+   REPLAY_EV_MOUSE_PRESS,
+   REPLAY_EV_MOUSE_RELEASE,
+   REPLAY_EV_RESET
+  };
+
+// Hora amb què s'inicialitza el rellotge del PC.
+typedef struct
+{
+
+  uint8_t ss;
+  uint8_t mm;
+  uint8_t hh;
+  uint8_t day_week;
+  uint8_t day_month;
+  uint8_t month;
+  int     year;
+
+} replay_time_t;
+
+// Passa al simulador un esdeveniment d'entrada de tipus 'type' (no
+// REPLAY_EV_END ni REPLAY_EV_RESET) i, si s'està gravant, el desa en
+// la pel·lícula. 'b' sols s'empra en REPLAY_EV_MOUSE_MOTION.
+void
+replay_input (
+              const int type,
+              const int a,
+              const int b
+              );
+
+// Reprodueix la pel·lícula oberta amb init_movie_replay fins al
+// final, tan ràpid com es puga, i imprimeix estadístiques. El disc
+// dur es munta sobre una còpia en memòria. Torna false si la
+// pel·lícula no es pot reproduir.
+bool
+replay_run (
+            const gchar         *hdd_fn,
+            const gchar         *disc_D, // Pot ser NULL
+            const gchar         *disc_A, // Pot ser NULL
+            const gchar         *disc_B, // Pot ser NULL
+            const unsigned long  max_frames, // 0 sense límit
+            const bool           verbose
+            );
+
+// Comença la gravació preparada amb init_movie_record. S'ha de
+// cridar just després d'inicialitzar el simulador. 'time' és l'hora
+// que ha rebut el simulador, o NULL si encara no l'ha demanada.
+bool
+replay_start_record (
+                     const uint8_t       *bios,
+                     const size_t         bios_size,
+                     const uint8_t       *vgabios,
+                     const size_t         vgabios_size,
+                     const replay_time_t *time
+                     );
+
+#endif // __REPLAY_H__
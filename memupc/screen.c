@@ -31,8 +31,10 @@
 
 #include "PC.h"
 #include "error.h"
+#include "frametime.h"
 #include "icon.h"
 #include "lock.h"
+#include "metrics.h"
 #include "screen.h"
 #include "windowtex.h"
 
@@ -46,6 +48,10 @@
 #define MAX_WIDTH 1600
 #define MAX_HEIGHT 1200
 
+// En mode turbo es presenta com a molt un fotograma cada
+// TURBO_FRAME_MS mil·lisegons.
+#define TURBO_FRAME_MS 16
+
 
 
 
@@ -66,13 +72,25 @@ static struct
 
   tex_t       *tex;
   draw_area_t  area;
+  bool         full; // Cal tornar a pujar totes les línies.
   
 } _fb;
 
 static uint32_t _frame[MAX_WIDTH*MAX_HEIGHT];
 
+// Còpia de l'últim fotograma rebut, per a detectar les línies que
+// han canviat.
+static PC_RGB _last[MAX_WIDTH*MAX_HEIGHT];
+
 static bool _cursor_enabled;
 
+// Mode turbo.
+static struct
+{
+  bool   enabled;
+  Uint32 last;
+} _turbo;
+
 
 
 
@@ -116,23 +134,38 @@ decode_screen_size (
 } // end decode_screen_size
 
 
-static void
+// Sols converteix les línies que han canviat des de l'últim
+// fotograma. Torna false si no n'ha canviat cap, si no en 'row0' i
+// 'row1' torna la primera línia canviada i la següent a l'última.
+static bool
 render_frame (
               const PC_RGB *fb,
               const int     width,
               const int     height,
-              const int     line_stride
+              const int     line_stride,
+              int          *row0,
+              int          *row1
               )
 {
 
   int r,c;
   uint8_t *p;
-
+  PC_RGB *last;
+  size_t line_size;
+  
   
   assert ( width <= MAX_WIDTH && height <= MAX_HEIGHT );
-  p= (uint8_t *) &_frame[0];
-  for ( r= 0; r < height; ++r )
+  *row0= height;
+  *row1= 0;
+  line_size= width*sizeof(PC_RGB);
+  last= &_last[0];
+  for ( r= 0; r < height; ++r, fb+= line_stride, last+= width )
     {
+      if ( !_fb.full && memcmp ( last, fb, line_size ) == 0 ) continue;
+      memcpy ( last, fb, line_size );
+      if ( r < *row0 ) *row0= r;
+      *row1= r+1;
+      p= (uint8_t *) &_frame[r*width];
       for ( c= 0; c < width; ++c )
         {
           *(p++)= ((uint8_t) fb[c].r);
@@ -140,8 +173,10 @@ render_frame (
           *(p++)= ((uint8_t) fb[c].b);
           *(p++)= 0xFF;
         }
-      fb+= line_stride;
     }
+  _fb.full= false;
+  
+  return *row1 > 0;
   
 } // end render_frame
 
@@ -172,6 +207,7 @@ update_fb (
       _fb.tex= windowtex_create_tex_fmt ( width, height,
                                           SDL_PIXELFORMAT_RGBA32, true );
       SDL_SetTextureScaleMode ( _fb.tex->tex, SDL_ScaleModeLinear );
+      _fb.full= true;
     }
   
   // Fixa valors àrea de dibuix.
@@ -395,6 +431,7 @@ screen_change_vsync (
     {
       _fb.tex= windowtex_create_tex_fmt ( w, h, SDL_PIXELFORMAT_RGBA32, false );
       tex_clear ( _fb.tex );
+      _fb.full= true;
     }
   
 } // end screen_change_vsync
@@ -410,14 +447,37 @@ screen_update (
                )
 {
 
+  int64_t t0;
+  int row0,row1;
+  bool dirty;
+  
+
+  // En mode turbo el simulador genera molts més fotogrames dels que
+  // es poden mostrar.
+  if ( _turbo.enabled )
+    {
+      if ( SDL_GetTicks () - _turbo.last < TURBO_FRAME_MS ) return;
+      _turbo.last= SDL_GetTicks ();
+    }
+  
   // IGNORA GRANDÀRIES MOLT MENUDES
   if ( width >= 100 && height >= 100 )
     {
       if ( _fb.tex == NULL || width != _fb.tex->w || height != _fb.tex->h )
         update_fb ( width, height );
-      render_frame ( fb, width, height, line_stride );
-      tex_copy_fb ( _fb.tex, _frame, width, height );
-      draw ();
+      t0= frametime_begin ();
+      dirty= render_frame ( fb, width, height, line_stride, &row0, &row1 );
+      if ( dirty ) tex_copy_fb_rows ( _fb.tex, _frame, width, row0, row1 );
+      frametime_end ( FRAMETIME_COPY, t0 );
+      
+      // Si no ha canviat res no cal tornar a presentar el fotograma
+      // (SDL_WINDOWEVENT_EXPOSED ja redibuixa).
+      if ( dirty )
+        {
+          draw ();
+          frametime_frame ();
+          metrics_frame ();
+        }
     }
   
 } // end screen_update
@@ -462,3 +522,22 @@ screen_grab_cursor (
 {
   windowtex_grab_cursor ( grab );
 } // end screen_grab_cursor
+
+
+void
+screen_set_turbo (
+                  const bool enabled
+                  )
+{
+
+  _turbo.enabled= enabled;
+  _turbo.last= 0;
+  
+} // end screen_set_turbo
+
+
+void
+screen_invalidate (void)
+{
+  _fb.full= true;
+} // end screen_invalidate
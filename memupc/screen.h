@@ -100,4 +100,15 @@ screen_grab_cursor (
                     const bool grab
                     );
 
+// Força que el següent fotograma es puge i es presente sencer, encara
+// que no haja canviat (p.e. després de mostrar el menú).
+void
+screen_invalidate (void);
+
+// En mode turbo limita els fotogrames que es presenten.
+void
+screen_set_turbo (
+                  const bool enabled
+                  );
+
 #endif // __SCREEN_H__
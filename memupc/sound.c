@@ -24,12 +24,15 @@
 
 #include <assert.h>
 #include <glib.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <SDL.h>
 
 #include "error.h"
+#include "frametime.h"
+#include "metrics.h"
 #include "sound.h"
 
 
@@ -77,6 +80,9 @@ static struct
 
 static SDL_AudioDeviceID _dev;
 
+// En mode turbo no s'espera a que es buide el buffer.
+static bool _turbo;
+
 
 
 
@@ -107,7 +113,7 @@ fill_audio_data (
     }
   else
     {
-      /*printf("XOF!!\n");*/
+      metrics_audio_underrun ();
       for ( i= 0; i < len; ++i ) stream[i]= _abuf.silence;
     }
   
@@ -184,15 +190,23 @@ sound_play (
   
   int nofull, j;
   int16_t *buffer;
+  int64_t t0;
   
   
+  t0= frametime_begin ();
   for (;;)
     {
       
+      j= (int) (_abuf.pos2 + 0.5);
+      if ( _turbo && _abuf.buffers[_abuf.buff_in].full )
+        {
+          metrics_audio_dropped ( PC_AUDIO_BUFFER_SIZE-j );
+          _abuf.pos2= 0.0;
+          break;
+        }
       while ( _abuf.buffers[_abuf.buff_in].full ) SDL_Delay ( 1 );
       buffer= _abuf.buffers[_abuf.buff_in].v;
       
-      j= (int) (_abuf.pos2 + 0.5);
       while ( (nofull= (_abuf.pos != _abuf.nsamples)) &&
               j < PC_AUDIO_BUFFER_SIZE )
         {
@@ -214,5 +228,15 @@ sound_play (
         }
       
     }
+  frametime_end ( FRAMETIME_SOUND, t0 );
   
 } // end sound_play
+
+
+void
+sound_set_turbo (
+                 const bool enabled
+                 )
+{
+  _turbo= enabled;
+} // end sound_set_turbo
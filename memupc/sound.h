@@ -24,6 +24,8 @@
 #ifndef __SOUND_H__
 #define __SOUND_H__
 
+#include <stdbool.h>
+
 #include "PC.h"
 
 void
@@ -39,4 +41,11 @@ sound_play (
             void          *udata
             );
 
+// En mode turbo es descarten les mostres que no caben en el buffer
+// en compte d'esperar.
+void
+sound_set_turbo (
+                 const bool enabled
+                 );
+
 #endif // __SOUND_H__
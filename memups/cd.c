@@ -31,6 +31,7 @@
 #include "cd.h"
 #include "error.h"
 #include "fchooser.h"
+#include "movie.h"
 
 #include "CD.h"
 #include "PSX.h"
@@ -100,6 +101,7 @@ cd_set_disc (
           if ( _disc != NULL ) CD_disc_free ( _disc );
           _disc= NULL;
           PSX_set_disc ( _disc );
+          movie_stop_record ( "s'ha canviat el disc" );
           stop= true;
         }
       else
@@ -144,6 +146,7 @@ cd_set_disc_from_file_name (
       if ( _disc != NULL ) CD_disc_free ( _disc );
       _disc= cd_new;
       PSX_set_disc ( _disc );
+      movie_stop_record ( "s'ha canviat el disc" );
       ret= true;
     }
   
@@ -30,9 +30,11 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "cd.h"
 #include "error.h"
+#include "frametime.h"
 #include "frontend.h"
 /*
 #include "hud.h"
@@ -40,7 +42,10 @@
 #include "load_bios.h"
 #include "memc.h"
 #include "menu.h"
+#include "metrics.h"
+#include "movie.h"
 #include "pad.h"
+#include "replay.h"
 #include "screen.h"
 #include "sound.h"
 /*
@@ -115,7 +120,7 @@ check_signals (
   
   
   *stop= false;
-  *reset= _reset; _reset= false;
+  *reset= movie_sample ( _reset ) != 0; _reset= false;
   while ( screen_next_event ( &event, NULL ) )
     switch ( event.type )
       {
@@ -188,20 +193,17 @@ static void
 loop (void)
 {
 
-  // Un valor un poc arreu. Si cada T és correspon amb un cicle de
-  // rellotge que va a 33.87MHz approx, tenim que és comprova cada
-  // 1/100 segons.
-  static const int CCTOCHECK= 338700;
-  
   const gint64 SLEEP= 1000;
   const gint64 MIN_DELAY= -10000;
   
   int cc,cc_iter;
   gint64 t0,tf,delay;
+  int64_t ts;
   bool stop;
 
 
   screen_enable_cursor ( true );
+  frametime_restart ();
   stop= false;
   t0= g_get_monotonic_time ();
   cc_iter= (int) ((PSX_CYCLES_PER_SEC/1000000.0)*SLEEP + 0.5);
@@ -221,14 +223,58 @@ loop (void)
       // Delay
       tf= g_get_monotonic_time ();
       delay+= SLEEP-(tf-t0); t0= tf;
-      if ( delay >= SLEEP ) g_usleep ( SLEEP );
+      if ( delay >= SLEEP )
+        {
+          ts= frametime_begin ();
+          g_usleep ( SLEEP );
+          frametime_end ( FRAMETIME_SLEEP, ts );
+        }
       else if ( delay < MIN_DELAY ) delay= MIN_DELAY;
+      metrics_loop ( SLEEP, delay == MIN_DELAY );
       
     }
   
 } // end loop
 
 
+// Comença la gravació preparada en main (si n'hi ha). S'ha de cridar
+// just després d'inicialitzar el simulador.
+static void
+start_record (
+              const uint8_t *bios
+              )
+{
+
+  FILE *f;
+  replay_conf_t conf;
+  const uint8_t *mem;
+  int i;
+  
+  
+  if ( !movie_record_waiting () ) return;
+  f= movie_state_open_write ();
+  if ( f == NULL ) return;
+  memset ( &conf, 0, sizeof(conf) );
+  conf.controllers[0]= _controllers[0];
+  conf.controllers[1]= _controllers[1];
+  if ( fwrite ( bios, PSX_BIOS_SIZE, 1, f ) != 1 ) goto error;
+  for ( i= 0; i < 2; ++i )
+    if ( (mem= memc_get ( i )) != NULL )
+      {
+        conf.memc[i]= 1;
+        if ( fwrite ( mem, MEMCARD_SIZE, 1, f ) != 1 ) goto error;
+      }
+  replay_start_record ( &conf, f );
+  
+  return;
+  
+ error:
+  warning ( "no s'ha pogut desar l'estat inicial de la pel·lícula" );
+  fclose ( f );
+  
+} // end start_record
+
+
 
 
 /**********************/
@@ -244,6 +290,8 @@ close_frontend (void)
   PSX_renderer_free ( _renderer );
   close_menu ();
   close_t8biso ();
+  close_tiles16b ();
+  close_tiles8b ();
   close_pad ();
   close_sound ();
   close_screen ();
@@ -274,6 +322,7 @@ frontend_run (
   PSX_plug_controllers ( _controllers[0], _controllers[1] );
   memc_replug ();
   if ( disc_fn != NULL ) cd_set_disc_from_file_name ( disc_fn );
+  start_record ( bios );
   
   // Executa loop.
   for (;;)
@@ -329,7 +378,7 @@ init_frontend (
   _frontend.warning= _warning;
   _frontend.check= check_signals;
   _frontend.play_sound= sound_play;
-  _frontend.get_ctrl_state= pad_get_controller_state;
+  _frontend.get_ctrl_state= pad_sample_controller_state;
   _frontend.trace= NULL;
 
   // Renderer.
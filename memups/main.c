@@ -34,8 +34,13 @@
 #include "conf.h"
 #include "dirs.h"
 #include "error.h"
+#include "framehash.h"
+#include "frametime.h"
 #include "frontend.h"
 #include "lock.h"
+#include "metrics.h"
+#include "movie.h"
+#include "replay.h"
 #include "session.h"
 
 #include "PSX.h"
@@ -72,6 +77,14 @@ struct opts
   gchar    *conf_fn;
   gchar    *title;
   gboolean  big_screen;
+  gchar    *record_fn;
+  gchar    *replay_fn;
+  gint      frames;
+  gchar    *golden_fn;
+  gboolean  write_golden;
+  gint      hash_period;
+  gchar    *frame_csv_fn;
+  gchar    *metrics_fn;
   
 };
 
@@ -97,7 +110,15 @@ usage (
      NULL,     // session_name
      NULL,     // conf_fn
      NULL,     // title
-     FALSE     // big_screen
+     FALSE,    // big_screen
+     NULL,     // record_fn
+     NULL,     // replay_fn
+     0,        // frames
+     NULL,     // golden_fn
+     FALSE,    // write_golden
+     60,       // hash_period
+     NULL,     // frame_csv_fn
+     NULL      // metrics_fn
     };
   
   static GOptionEntry entries[]=
@@ -108,6 +129,33 @@ usage (
       { "conf", 'c', 0, G_OPTION_ARG_STRING, &vals.conf_fn,
         "Empra com a fitxer de configuració CONF",
         "CONF" },
+      { "frame-csv", 0, 0, G_OPTION_ARG_STRING, &vals.frame_csv_fn,
+        "Escriu en CSV el temps (en microsegons) que es gasta en cada"
+        " etapa de cada fotograma",
+        "CSV" },
+      { "metrics", 0, 0, G_OPTION_ARG_STRING, &vals.metrics_fn,
+        "Serveix mètriques en format de Prometheus en el socket UNIX SOCKET",
+        "SOCKET" },
+      { "record", 0, 0, G_OPTION_ARG_STRING, &vals.record_fn,
+        "Grava en MOVIE l'entrada dels controladors des de l'encesa",
+        "MOVIE" },
+      { "replay", 0, 0, G_OPTION_ARG_STRING, &vals.replay_fn,
+        "Reprodueix MOVIE sense finestra ni so, tan ràpid com es puga,"
+        " i imprimeix estadístiques",
+        "MOVIE" },
+      { "frames", 0, 0, G_OPTION_ARG_INT, &vals.frames,
+        "Amb --replay, para després de N fotogrames",
+        "N" },
+      { "golden", 0, 0, G_OPTION_ARG_STRING, &vals.golden_fn,
+        "Amb --replay, compara els hashos de la imatge i el so amb els"
+        " de GOLDEN i acaba amb error si no coincideixen",
+        "GOLDEN" },
+      { "write-golden", 0, 0, G_OPTION_ARG_NONE, &vals.write_golden,
+        "Amb --golden, escriu GOLDEN en compte de comparar",
+        NULL },
+      { "hash-period", 0, 0, G_OPTION_ARG_INT, &vals.hash_period,
+        "Amb --golden, calcula un hash cada N fotogrames (60 per defecte)",
+        "N" },
       { "title", 't', 0, G_OPTION_ARG_STRING, &vals.title,
         "Fixa el nom de la finestra (sols amb ROM)",
         "TITLE" },
@@ -142,6 +190,12 @@ usage (
     error ( "número d'arguments incorrecte" );
   else if ( *argc-1 == 1 )
     args->disc_fn= (*argv)[1];
+  if ( opts->record_fn != NULL && opts->replay_fn != NULL )
+    error ( "no es pot gravar i reproduir al mateix temps" );
+  if ( opts->golden_fn != NULL && opts->replay_fn == NULL )
+    error ( "--golden sols es pot emprar amb --replay" );
+  if ( opts->frames < 0 || opts->hash_period <= 0 )
+    error ( "el nombre de fotogrames no és vàlid" );
   
 } // end usage
 
@@ -154,6 +208,11 @@ free_opts (
 
   if ( opts->session_name != NULL ) g_free ( opts->session_name );
   if ( opts->conf_fn != NULL ) g_free ( opts->conf_fn );
+  if ( opts->frame_csv_fn != NULL ) g_free ( opts->frame_csv_fn );
+  if ( opts->metrics_fn != NULL ) g_free ( opts->metrics_fn );
+  if ( opts->record_fn != NULL ) g_free ( opts->record_fn );
+  if ( opts->replay_fn != NULL ) g_free ( opts->replay_fn );
+  if ( opts->golden_fn != NULL ) g_free ( opts->golden_fn );
   
 } // end free_opts
 
@@ -187,6 +246,40 @@ get_title (
 } // end get_title
 
 
+// Identificador de la pel·lícula.
+static gchar *
+get_movie_id (
+              const gchar *disc_fn
+              )
+{
+  return disc_fn!=NULL ? g_path_get_basename ( disc_fn ) : g_strdup ( "" );
+} // end get_movie_id
+
+
+static void
+run_replay (
+            const struct args *args,
+            const struct opts *opts
+            )
+{
+
+  gchar *id;
+  
+
+  id= get_movie_id ( args->disc_fn );
+  if ( opts->golden_fn != NULL )
+    init_framehash ( opts->golden_fn, opts->write_golden, opts->hash_period );
+  if ( !init_movie_replay ( opts->replay_fn, "PSX", id, opts->verbose ) ||
+       !replay_run ( args->disc_fn, opts->frames, opts->verbose ) )
+    error ( "no s'ha pogut reproduir '%s'", opts->replay_fn );
+  close_movie ();
+  g_free ( id );
+  if ( !close_framehash () )
+    error ( "la reproducció no coincideix amb '%s'", opts->golden_fn );
+  
+} // end run_replay
+
+
 static void
 run (
      const struct args *args,
@@ -195,7 +288,7 @@ run (
 {
   
   conf_t conf;
-  gchar *title;
+  gchar *title, *id;
   
   
   // Inicialitza
@@ -209,7 +302,14 @@ run (
       g_free ( title );
       
       // Executa.
+      if ( opts->record_fn != NULL )
+        {
+          id= get_movie_id ( args->disc_fn );
+          init_movie_record ( opts->record_fn, "PSX", id, opts->verbose );
+          g_free ( id );
+        }
       frontend_run ( args->disc_fn );
+      close_movie ();
       
       // Allibera memòria i tanca
       close_frontend ();
@@ -242,7 +342,14 @@ int main ( int argc, char *argv[] )
   usage ( &argc, &argv, &args, &opts );
   
   // Executa.
-  run ( &args, &opts );
+  if ( opts.frame_csv_fn != NULL )
+    init_frametime ( false, opts.frame_csv_fn );
+  if ( opts.metrics_fn != NULL )
+    init_metrics ( opts.metrics_fn, "PSX" );
+  if ( opts.replay_fn != NULL ) run_replay ( &args, &opts );
+  else                          run ( &args, &opts );
+  close_metrics ();
+  close_frametime ();
   
   // Despedida.
   free_opts ( &opts );
@@ -35,21 +35,14 @@
 #include "error.h"
 #include "fchooser.h"
 #include "memc.h"
+#include "metrics.h"
+#include "movie.h"
 
 #include "PSX.h"
 
 
 
 
-/**********/
-/* MACROS */
-/**********/
-
-#define MEMCARD_SIZE (128*1024)
-
-
-
-
 /*********/
 /* TIPUS */
 /*********/
@@ -186,6 +179,8 @@ write_memc (
               name, strerror ( errno ) );
     }
   
+  metrics_save_flush ();
+  
   // Allibera memòria.
   g_free ( tmp );
   
@@ -337,8 +332,18 @@ memc_replug (void)
   uint8_t *mem1,*mem2;
 
   
+  movie_stop_record ( "s'han canviat les memory cards" );
   mem1= _conf->memc_fn[0]!=NULL ? &(_mc[0][0]) : NULL;
   mem2= _conf->memc_fn[1]!=NULL ? &(_mc[1][0]) : NULL;
   PSX_plug_mem_cards ( mem1, mem2 );
   
 } // memc_replug
+
+
+const uint8_t *
+memc_get (
+          const int port
+          )
+{
+  return _conf->memc_fn[port]!=NULL ? &(_mc[port][0]) : NULL;
+} // end memc_get
@@ -25,9 +25,12 @@
 #define __MEMC_H__
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "conf.h"
 
+#define MEMCARD_SIZE (128*1024)
+
 void
 close_memc (void);
 
@@ -49,4 +52,11 @@ memc_set (
 void
 memc_replug (void);
 
+// Torna el contingut de la memory card del port indicat (0 o 1), o
+// NULL si no n'hi ha.
+const uint8_t *
+memc_get (
+          const int port
+          );
+
 #endif // __MEMC_H__
@@ -36,6 +36,7 @@
 #include "load_bios.h"
 #include "memc.h"
 #include "menu.h"
+#include "movie.h"
 #include "mpad.h"
 #include "pad.h"
 #include "PSX.h"
@@ -668,6 +669,7 @@ port1_action (
   else ++_conf->controllers[0];
 
   PSX_plug_controllers ( _conf->controllers[0], _conf->controllers[1] );
+  movie_stop_record ( "s'han canviat els controladors" );
 
   return CONTINUE;
   
@@ -700,6 +702,7 @@ port2_action (
   else ++_conf->controllers[1];
 
   PSX_plug_controllers ( _conf->controllers[0], _conf->controllers[1] );
+  movie_stop_record ( "s'han canviat els controladors" );
 
   return CONTINUE;
   
@@ -23,6 +23,7 @@
 
 
 #include <assert.h>
+#include <glib.h>
 #include <SDL.h>
 #include <stdbool.h>
 #include <stddef.h>
@@ -30,12 +31,27 @@
 #include <string.h>
 
 #include "error.h"
+#include "movie.h"
 #include "pad.h"
 #include "PSX.h"
 
 
 
 
+/*************/
+/* CONSTANTS */
+/*************/
+
+// Interval mínim (en microsegons) entre dos lectures de l'entrada
+// forçades des de pad_get_controller_state.
+#define LATCH_INTERVAL 1000
+
+// Nombre màxim d'events que es revisen en cada lectura.
+#define LATCH_NEVENTS 64
+
+
+
+
 /*********/
 /* ESTAT */
 /*********/
@@ -66,6 +82,9 @@ static struct
 // Estat PSX.
 static PSX_ControllerState _state[2];
 
+// Moment de l'última lectura forçada de l'entrada.
+static gint64 _last_latch;
+
 
 
 
@@ -318,6 +337,42 @@ process_joy_event (
 } // end process_joy_event
 
 
+// Llig l'entrada en el moment en què el simulador consulta el
+// controlador, en compte d'esperar a la següent crida a
+// check_signals. Els events de teclat i joystick pendents s'apliquen
+// sense traure'ls de la cua, quan check_signals els processe es
+// tornaran a aplicar en el mateix ordre i l'estat final serà el
+// mateix. Les tecles amb CTRL o ALT no arriben al pad (veure
+// check_signals).
+static void
+latch (void)
+{
+
+  SDL_Event events[LATCH_NEVENTS];
+  int n, i;
+  gint64 now;
+  bool esc;
+  
+  
+  now= g_get_monotonic_time ();
+  if ( now-_last_latch < LATCH_INTERVAL ) return;
+  _last_latch= now;
+  
+  SDL_PumpEvents ();
+  n= SDL_PeepEvents ( events, LATCH_NEVENTS, SDL_PEEKEVENT,
+                      SDL_KEYDOWN, SDL_KEYUP );
+  for ( i= 0; i < n; ++i )
+    if ( events[i].type == SDL_KEYUP ||
+         !(events[i].key.keysym.mod&(KMOD_CTRL|KMOD_ALT)) )
+      pad_event ( &events[i] );
+  n= SDL_PeepEvents ( events, LATCH_NEVENTS, SDL_PEEKEVENT,
+                      SDL_JOYAXISMOTION, SDL_JOYBUTTONUP );
+  for ( i= 0; i < n; ++i )
+    process_joy_event ( &events[i], &esc );
+  
+} // end latch
+
+
 
 
 /**********************/
@@ -345,6 +400,7 @@ init_pad (
   _jbuttons[0].stick= _jbuttons[1].stick= 0;
   _state[0].buttons= 0;
   _state[1].buttons= 1;
+  _last_latch= 0;
   
   // Si hi ha jostick l'obri.
   _joy[0].dev= _joy[1].dev= NULL;
@@ -367,6 +423,7 @@ pad_get_controller_state (
   uint16_t ret;
 
   
+  latch ();
   ret= (uint16_t)
     (_kbuttons[joy] | _jbuttons[joy].buttons | _jbuttons[joy].stick);
   if ( (ret&(PSX_BUTTON_UP|PSX_BUTTON_DOWN)) ==
@@ -382,6 +439,21 @@ pad_get_controller_state (
 } // end pad_get_controller_state
 
 
+const PSX_ControllerState *
+pad_sample_controller_state (
+                             const int  joy,
+                             void      *udata
+                             )
+{
+
+  pad_get_controller_state ( joy, udata );
+  _state[joy].buttons= (uint16_t) movie_sample ( _state[joy].buttons );
+  
+  return &_state[joy];
+  
+} // end pad_sample_controller_state
+
+
 void
 pad_clear (void)
 {
@@ -51,6 +51,14 @@ pad_get_controller_state (
                           void      *udata
                           );
 
+// Com pad_get_controller_state però enregistra/reprodueix la lectura
+// en el moviment. Sols l'ha de cridar el simulador.
+const PSX_ControllerState *
+pad_sample_controller_state (
+                             const int  joy,
+                             void      *udata
+                             );
+
 void
 pad_clear (void);
 
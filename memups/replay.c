@@ -0,0 +1,310 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/memus.
+ *
+ * adriagipas/memus is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/memus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/memus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  replay.c - Implementació de 'replay.h'.
+ *
+ *  No s'inicialitza SDL. Les memory cards són còpies temporals que no
+ *  es desen.
+ *
+ */
+
+
+#include <glib.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cd.h"
+#include "error.h"
+#include "framehash.h"
+#include "memc.h"
+#include "movie.h"
+#include "replay.h"
+
+
+
+
+/**********/
+/* MACROS */
+/**********/
+
+// Configuració serialitzada en la pel·lícula. Cada camp s'escriu
+// explícitament perquè el format no depenga de com el compilador
+// organitza replay_conf_t: controllers[0], controllers[1], memc[0],
+// memc[1].
+#define CONF_SIZE 4
+
+
+
+
+/*********/
+/* ESTAT */
+/*********/
+
+// Fotogrames generats i màxim (0 sense límit).
+static unsigned long _frames;
+static unsigned long _max_frames;
+
+// BIOS i memory cards de la pel·lícula.
+static uint8_t _bios[PSX_BIOS_SIZE];
+static uint8_t _mc[2][MEMCARD_SIZE];
+
+// Estat dels controladors.
+static PSX_ControllerState _state[2];
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+static void
+_warning (
+          void       *udata,
+          const char *format,
+          ...
+          )
+{
+  
+  va_list ap;
+  
+  
+  va_start ( ap, format );
+  vwarning ( format, ap );
+  va_end ( ap );
+  
+} // end _warning
+
+
+static void
+check (
+       bool *stop,
+       bool *reset,
+       void *udata
+       )
+{
+  
+  *reset= movie_sample ( 0 ) != 0;
+  *stop= movie_end () || (_max_frames > 0 && _frames >= _max_frames);
+  
+} // end check
+
+
+static void
+play_sound (
+            const int16_t  samples[PSX_AUDIO_BUFFER_SIZE*2],
+            void          *udata
+            )
+{
+  framehash_audio ( samples, sizeof(int16_t)*PSX_AUDIO_BUFFER_SIZE*2 );
+} // end play_sound
+
+
+static const PSX_ControllerState *
+get_ctrl_state (
+                const int  joy,
+                void      *udata
+                )
+{
+  
+  _state[joy].buttons= (uint16_t) movie_sample ( 0 );
+  
+  return &_state[joy];
+  
+} // end get_ctrl_state
+
+
+static void
+update_screen (
+               const uint32_t                 *fb,
+               const PSX_UpdateScreenGeometry *g,
+               void                           *udata
+               )
+{
+
+  int geo[6];
+  
+  
+  geo[0]= g->width; geo[1]= g->height;
+  geo[2]= g->x0; geo[3]= g->x1;
+  geo[4]= g->y0; geo[5]= g->y1;
+  framehash_video_data ( geo, sizeof(geo) );
+  framehash_video ( fb, sizeof(uint32_t)*g->width*g->height );
+  ++_frames;
+  
+} // end update_screen
+
+
+// Llig la BIOS i les memory cards.
+static bool
+read_state (
+            const replay_conf_t *conf
+            )
+{
+
+  FILE *f;
+  int i;
+  
+  
+  f= movie_state_open_read ();
+  if ( f == NULL ) return false;
+  if ( fread ( _bios, PSX_BIOS_SIZE, 1, f ) != 1 ) goto error;
+  for ( i= 0; i < 2; ++i )
+    if ( conf->memc[i] && fread ( _mc[i], MEMCARD_SIZE, 1, f ) != 1 )
+      goto error;
+  fclose ( f );
+  
+  return true;
+  
+ error:
+  fclose ( f );
+  return false;
+  
+} // end read_state
+
+
+static bool
+read_conf (
+           replay_conf_t *conf
+           )
+{
+
+  const uint8_t *buf;
+  
+
+  buf= movie_get_config ( CONF_SIZE );
+  if ( buf == NULL ) return false;
+  memset ( conf, 0, sizeof(*conf) );
+  conf->controllers[0]= buf[0];
+  conf->controllers[1]= buf[1];
+  conf->memc[0]= buf[2]!=0;
+  conf->memc[1]= buf[3]!=0;
+  
+  return true;
+  
+} // end read_conf
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+bool
+replay_run (
+            const gchar         *disc_fn,
+            const unsigned long  max_frames,
+            const bool           verbose
+            )
+{
+
+  PSX_Frontend frontend;
+  PSX_Renderer *renderer;
+  replay_conf_t conf;
+  bool stop;
+  gint64 t0,tf;
+  uint64_t cc;
+  double secs;
+  
+  
+  // Configuració i estat inicial.
+  if ( !read_conf ( &conf ) || !read_state ( &conf ) )
+    {
+      warning ( "la pel·lícula no té una configuració vàlida" );
+      return false;
+    }
+  
+  // Inicialitza.
+  frontend.warning= _warning;
+  frontend.check= check;
+  frontend.play_sound= play_sound;
+  frontend.get_ctrl_state= get_ctrl_state;
+  frontend.trace= NULL;
+  renderer= PSX_create_default_renderer ( update_screen, NULL );
+  if ( renderer == NULL )
+    {
+      warning ( "no s'ha pogut crear el PSX_Renderer" );
+      return false;
+    }
+  _frames= 0;
+  _max_frames= max_frames;
+  memset ( _state, 0, sizeof(_state) );
+  init_cd ( verbose );
+  PSX_init ( _bios, &frontend, NULL, renderer );
+  PSX_plug_controllers ( conf.controllers[0], conf.controllers[1] );
+  PSX_plug_mem_cards ( conf.memc[0] ? _mc[0] : NULL,
+                       conf.memc[1] ? _mc[1] : NULL );
+  if ( disc_fn != NULL && !cd_set_disc_from_file_name ( disc_fn ) )
+    {
+      close_cd ();
+      PSX_renderer_free ( renderer );
+      return false;
+    }
+  
+  // Executa.
+  t0= g_get_monotonic_time ();
+  cc= 0;
+  stop= false;
+  while ( !stop )
+    cc+= PSX_iter ( CCTOCHECK, &stop );
+  tf= g_get_monotonic_time ();
+  
+  // Estadístiques.
+  secs= (tf-t0)/1000000.0;
+  printf ( "Mostres:    %lu\n", (unsigned long) movie_get_nsamples () );
+  printf ( "Fotogrames: %lu\n", _frames );
+  printf ( "Cicles:     %lu\n", (unsigned long) cc );
+  printf ( "Temps:      %.3f s (%.1f fotogrames/s)\n",
+           secs, secs > 0 ? _frames/secs : 0.0 );
+  if ( verbose )
+    fprintf ( stderr, "Reproducció acabada\n" );
+  
+  // Allibera.
+  close_cd ();
+  PSX_renderer_free ( renderer );
+  
+  return true;
+  
+} // end replay_run
+
+
+bool
+replay_start_record (
+                     const replay_conf_t *conf,
+                     FILE                *state
+                     )
+{
+
+  uint8_t buf[CONF_SIZE];
+  
+
+  buf[0]= (uint8_t) conf->controllers[0];
+  buf[1]= (uint8_t) conf->controllers[1];
+  buf[2]= conf->memc[0] ? 1 : 0;
+  buf[3]= conf->memc[1] ? 1 : 0;
+  
+  return movie_start_record ( buf, CONF_SIZE, state );
+  
+} // end replay_start_record
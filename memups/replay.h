@@ -0,0 +1,72 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/memus.
+ *
+ * adriagipas/memus is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/memus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/memus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  replay.h - Reproducció de pel·lícules sense finestra ni so.
+ *
+ *  La PSX no té estats. Les pel·lícules sempre comencen en
+ *  l'encesa, i com a estat inicial es desa la BIOS seguida del
+ *  contingut de les memory cards connectades.
+ *
+ */
+
+#ifndef __REPLAY_H__
+#define __REPLAY_H__
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "PSX.h"
+
+// Un valor un poc arreu. Si cada T és correspon amb un cicle de
+// rellotge que va a 33.87MHz approx, tenim que és comprova cada
+// 1/100 segons. La reproducció ha d'emprar el mateix valor que la
+// gravació.
+#define CCTOCHECK 338700
+
+// Configuració que es desa en la pel·lícula.
+typedef struct
+{
+
+  PSX_Controller controllers[2];
+  uint8_t        memc[2]; // 1 si hi ha memory card.
+
+} replay_conf_t;
+
+// Reprodueix la pel·lícula oberta amb init_movie_replay fins al
+// final, tan ràpid com es puga, i imprimeix estadístiques. Torna
+// false si la pel·lícula no es pot reproduir.
+bool
+replay_run (
+            const gchar         *disc_fn, // Pot ser NULL
+            const unsigned long  max_frames, // 0 sense límit
+            const bool           verbose
+            );
+
+// Comença la gravació preparada amb init_movie_record desant 'conf'
+// en la pel·lícula. 'state' és el fitxer tornat per
+// movie_state_open_write amb l'estat inicial ja desat.
+bool
+replay_start_record (
+                     const replay_conf_t *conf,
+                     FILE                *state
+                     );
+
+#endif // __REPLAY_H__
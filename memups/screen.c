@@ -31,8 +31,10 @@
 
 #include "PSX.h"
 #include "error.h"
+#include "frametime.h"
 #include "icon.h"
 #include "lock.h"
+#include "metrics.h"
 #include "screen.h"
 #include "windowtex.h"
 
@@ -486,6 +488,9 @@ screen_update (
                void                           *udata
                )
 {
+
+  int64_t t0;
+  
   
   if ( _fb.tex == NULL ||
        g->width != _fb.tex->w ||
@@ -495,8 +500,12 @@ screen_update (
        g->y0 != _fb.old_g.y0 ||
        g->y1 != _fb.old_g.y1 )
     update_fb ( g );
+  t0= frametime_begin ();
   tex_copy_fb ( _fb.tex, fb, g->width, g->height );
+  frametime_end ( FRAMETIME_COPY, t0 );
   draw ();
+  frametime_frame ();
+  metrics_frame ();
   
 } // end screen_update
 
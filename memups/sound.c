@@ -30,6 +30,8 @@
 #include <SDL.h>
 
 #include "error.h"
+#include "frametime.h"
+#include "metrics.h"
 #include "sound.h"
 
 
@@ -107,7 +109,7 @@ fill_audio_data (
     }
   else
     {
-      /*printf("XOF!!\n");*/
+      metrics_audio_underrun ();
       for ( i= 0; i < len; ++i ) stream[i]= _abuf.silence;
     }
   
@@ -184,8 +186,10 @@ sound_play (
   
   int nofull, j;
   int16_t *buffer;
+  int64_t t0;
   
   
+  t0= frametime_begin ();
   for (;;)
     {
       
@@ -214,5 +218,6 @@ sound_play (
         }
       
     }
+  frametime_end ( FRAMETIME_SOUND, t0 );
   
 } // end sound_play
@@ -30,6 +30,7 @@
 
 #include "error.h"
 #include "t8biso.h"
+#include "textcache.h"
 
 
 
@@ -178,6 +179,9 @@ static const unsigned char MAP[256]=
 /* TIPUS */
 /*********/
 
+/* Bit privat que distingeix en la memòria cau les cadenes UTF-8. */
+#define CACHE_UTF8 0x100
+
 enum {
   BANNER_FITS,
   BANNER_BEGIN,
@@ -203,6 +207,13 @@ static struct
   
 } _toiso;
 
+/* Atlas: índex de color (0 fons, 1 primer pla) de cada píxel de cada
+   fila de cada tile. */
+static unsigned char _atlas[113][8][8];
+
+/* Cadenes ja convertides i rasteritzades. */
+static textcache_t _cache;
+
 
 
 
@@ -271,47 +282,117 @@ to_iso (
 } /* end to_iso */
 
 
+static void
+init_atlas (void)
+{
+
+  int t, r, c;
+  unsigned char byte;
+
+
+  for ( t= 0; t < 113; ++t )
+    for ( r= 0; r < 8; ++r )
+      {
+        byte= TILES[t][r];
+        for ( c= 0; c < 8; ++c )
+          {
+            _atlas[t][r][c]= (byte&0x80) ? 1 : 0;
+            byte<<= 1;
+          }
+      }
+
+} /* end init_atlas */
+
+
+/* Si mask no és NULL dibuixa tots els píxels i en 'mask' indica quins
+   s'haurien d'escriure. x i y en píxels. */
 static void
 draw_tile (
            int                 *fb,
+           unsigned char       *mask,
            const int            fb_width,
            const unsigned char  tile,
            const int            x,
            const int            y,
-           const int            fgcolor,
-           const int            bgcolor,
-           const int            flags
+           const int            colors[2],
+           const int            write[2]
            )
 {
   
-  int offset, r, c;
-  const unsigned char *pat;
-  unsigned char byte;
+  int offset, r, c, idx;
+  const unsigned char (*rows)[8];
   
   
-  pat= TILES[tile];
-  offset= y*8*fb_width + x*8;
+  rows= _atlas[tile];
+  offset= y*fb_width + x;
   for ( r= 0; r < 8; ++r )
     {
-      byte= pat[r];
-      for ( c= 0; c < 8; ++c )
-        {
-          if ( byte&0x80 )
-            {
-              if ( !(flags&T8BISO_FG_TRANS) ) fb[offset+c]= fgcolor;
-            }
-          else
-            {
-              if ( !(flags&T8BISO_BG_TRANS) ) fb[offset+c]= bgcolor;
-            }
-          byte<<= 1;
-        }
+      if ( mask != NULL )
+        for ( c= 0; c < 8; ++c )
+          {
+            idx= rows[r][c];
+            fb[offset+c]= colors[idx];
+            mask[offset+c]= write[idx];
+          }
+      else
+        for ( c= 0; c < 8; ++c )
+          {
+            idx= rows[r][c];
+            if ( write[idx] ) fb[offset+c]= colors[idx];
+          }
       offset+= fb_width;
     }
   
 } /* end draw_tile */
 
 
+/* 'key' és el text amb què es guarda en la memòria cau i 'string' el
+   text en ISO-8859-1 (pot ser NULL si encara no s'ha convertit). */
+static void
+draw_string (
+             int        *fb,
+             const int   fb_width,
+             const char *key,
+             const char *string,
+             int         x,
+             const int   y,
+             const int   fgcolor,
+             const int   bgcolor,
+             const int   flags,
+             const int   kflags
+             )
+{
+
+  const char *p;
+  int colors[3], write[2], i;
+  textcache_entry_t *e;
+
+
+  colors[0]= bgcolor; colors[1]= fgcolor; colors[2]= 0;
+  write[0]= !(flags&T8BISO_BG_TRANS); write[1]= !(flags&T8BISO_FG_TRANS);
+  e= textcache_lookup ( &_cache, key, colors, kflags );
+  if ( e == NULL )
+    {
+      if ( string == NULL ) string= to_iso ( key );
+      e= textcache_insert ( &_cache, key, colors, kflags,
+                            strlen ( string )*8, 8 );
+      if ( e == NULL ) /* Massa llarga. */
+        {
+          for ( p= string; *p; ++p, ++x )
+            draw_tile ( fb, NULL, fb_width, MAP[(unsigned char) *p],
+                        x*8, y*8, colors, write );
+          return;
+        }
+      for ( p= string, i= 0; *p; ++p, ++i )
+        draw_tile ( e->pix, e->mask, e->width, MAP[(unsigned char) *p],
+                    i*8, 0, colors, write );
+      textcache_commit ( e );
+    }
+  textcache_blit ( e, fb, fb_width, x*8, y*8 );
+
+} /* end draw_string */
+
+
 
 
 /**********************/
@@ -322,6 +403,7 @@ void
 close_t8biso (void)
 {
 
+  textcache_free ( &_cache );
   close_toiso ();
   
 } /* end close_t8biso */
@@ -332,6 +414,8 @@ init_t8biso (void)
 {
 
   init_toiso ();
+  init_atlas ();
+  textcache_init ( &_cache );
   
 } /* end init_t8biso */
 
@@ -348,14 +432,8 @@ t8biso_draw_string (
         	    const int   flags
         	    )
 {
-  
-  const char *p;
-  
-  
-  for ( p= string; *p; ++p, ++x )
-    draw_tile ( fb, fb_width, MAP[(unsigned char) *p],
-                x, y, fgcolor, bgcolor, flags );
-  
+  draw_string ( fb, fb_width, string, string, x, y, fgcolor, bgcolor,
+                flags, flags&(T8BISO_FG_TRANS|T8BISO_BG_TRANS) );
 } /* end t8biso_draw_string */
 
 
@@ -371,8 +449,8 @@ t8biso_draw_string_utf8 (
         		 const int   flags
         		 )
 {
-  t8biso_draw_string ( fb, fb_width, to_iso ( string ),
-        	       x, y, fgcolor, bgcolor, flags );
+  draw_string ( fb, fb_width, string, NULL, x, y, fgcolor, bgcolor, flags,
+                (flags&(T8BISO_FG_TRANS|T8BISO_BG_TRANS))|CACHE_UTF8 );
 } /* end t8biso_draw_string_utf8 */
 
 
@@ -405,8 +483,11 @@ t8biso_banner_set_msg (
         	       )
 {
 
+  static const int BANNER_COLORS[2]= {0,1};
+  static const int BANNER_WRITE[2]= {1,1};
+  
   const char *str;
-  int len;
+  int len, i;
   
 
   assert ( width > 0 );
@@ -422,9 +503,12 @@ t8biso_banner_set_msg (
       banner->fb_size= len;
     }
 
-  /* Inicialitza. */
+  /* Inicialitza (no passa per la memòria cau, es dibuixa una vegada). */
   banner->msg_width= len*8;
-  t8biso_draw_string ( banner->fb, banner->msg_width, str, 0, 0, 1, 0, 0 );
+  for ( i= 0; i < len; ++i )
+    draw_tile ( banner->fb, NULL, banner->msg_width,
+                MAP[(unsigned char) str[i]], i*8, 0,
+                BANNER_COLORS, BANNER_WRITE );
   banner->width= width;
   banner->pos= 0;
   banner->counter= 0;
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2026 Adrià Giménez Pastor.
+ *
+ * This file is part of adriagipas/memus.
+ *
+ * adriagipas/memus is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * adriagipas/memus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with adriagipas/memus.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ *  framehash.c - Comprova 'framehash.h' amb MD5 coneguts.
+ *
+ *  No necessita cap imatge, així que sempre s'executa encara que
+ *  els tests de reproducció es salten.
+ *
+ */
+
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "error.h"
+#include "framehash.h"
+
+
+
+
+/**********/
+/* MACROS */
+/**********/
+
+// MD5 de "" i de "abc" (RFC 1321).
+#define MD5_EMPTY "d41d8cd98f00b204e9800998ecf8427e"
+#define MD5_ABC   "900150983cd24fb0d6963f7d28e17f72"
+
+
+
+
+/*************/
+/* CONSTANTS */
+/*************/
+
+// Referència de 'feed' amb període 2.
+static const char GOLDEN[]=
+  "2 " MD5_ABC " " MD5_ABC "\n"
+  "3 " MD5_EMPTY " " MD5_EMPTY "\n";
+
+
+
+
+/*********************/
+/* FUNCIONS PRIVADES */
+/*********************/
+
+// Tres fotogrames: "ab"+"c" amb so "abc", "c" trencat entre
+// fotogrames i un fotograma buit que queda en el període incomplet.
+// Si 'bad' és cert el segon fotograma canvia.
+static void
+feed (
+      const bool bad
+      )
+{
+
+  framehash_video_data ( "ab", 2 );
+  framehash_video ( "", 0 );
+  framehash_audio ( "a", 1 );
+  framehash_audio ( "bc", 2 );
+  framehash_video ( bad ? "d" : "c", 1 );
+  framehash_video ( NULL, 0 );
+  
+} // end feed
+
+
+static bool
+check (
+       const char *fn,
+       const bool  bad,
+       const bool  expected
+       )
+{
+
+  bool ret;
+  
+
+  init_framehash ( fn, false, 2 );
+  feed ( bad );
+  ret= close_framehash ();
+  if ( ret != expected )
+    {
+      fprintf ( stderr, "FAIL la comparació amb '%s' ha tornat %d\n",
+                fn, ret );
+      return false;
+    }
+  
+  return true;
+  
+} // end check
+
+
+
+
+/**********************/
+/* FUNCIONS PÚBLIQUES */
+/**********************/
+
+int
+main (
+      int   argc,
+      char *argv[]
+      )
+{
+
+  gchar *fn,*text;
+  int fd;
+  bool ok;
+  
+
+  fd= g_file_open_tmp ( "framehash-XXXXXX", &fn, NULL );
+  if ( fd == -1 ) error ( "no s'ha pogut crear el fitxer temporal" );
+  close ( fd );
+  
+  // Escriptura.
+  init_framehash ( fn, true, 2 );
+  feed ( false );
+  ok= close_framehash ();
+  if ( !g_file_get_contents ( fn, &text, NULL, NULL ) )
+    error ( "no s'ha pogut llegir '%s'", fn );
+  if ( strcmp ( text, GOLDEN ) != 0 )
+    {
+      fprintf ( stderr, "FAIL s'esperava:\n%ss'ha obtingut:\n%s",
+                GOLDEN, text );
+      ok= false;
+    }
+  g_free ( text );
+  
+  // Lectura.
+  if ( ok ) ok= check ( fn, false, true );
+  if ( ok ) ok= check ( fn, true, false );
+  
+  unlink ( fn );
+  g_free ( fn );
+  
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+  
+} // end main
@@ -0,0 +1,57 @@
+#!/bin/sh
+#
+#  replay.sh - Reprodueix els moviments de CASES amb EXE i comprova
+#              els hashos de referència.
+#
+#  Ús: replay.sh EXE CASES SISTEMA DIR
+#
+#  Cada línia de CASES (les buides i les que comencen per # s'ignoren)
+#  és un cas:
+#
+#    SISTEMA IMATGE MOVIMENT FOTOGRAMES REFERÈNCIA
+#
+#  Sols s'executen els casos de SISTEMA. Els camins són relatius a DIR,
+#  o a $MEMUS_TEST_DATA si està definida. Els casos amb fitxers que no
+#  existeixen es salten. Si no s'executa cap cas torna 77, que meson
+#  interpreta com a test saltat.
+#
+
+set -u
+
+if [ $# -ne 4 ]; then
+    echo "ús: $0 EXE CASES SISTEMA DIR" >&2
+    exit 2
+fi
+exe=$1
+cases=$2
+sys=$3
+dir=${MEMUS_TEST_DATA:-$4}
+
+run=0
+fail=0
+while read -r csys image movie frames golden rest; do
+    case "$csys" in
+        ''|'#'*) continue ;;
+    esac
+    [ "$csys" = "$sys" ] || continue
+    if [ ! -f "$dir/$image" ] || [ ! -f "$dir/$movie" ] ||
+       [ ! -f "$dir/$golden" ]; then
+        echo "SKIP $image $movie: falten fitxers"
+        continue
+    fi
+    run=$((run+1))
+    if "$exe" --replay "$dir/$movie" --frames "$frames" \
+              --golden "$dir/$golden" "$dir/$image" < /dev/null; then
+        echo "OK   $image $movie"
+    else
+        echo "FAIL $image $movie"
+        fail=$((fail+1))
+    fi
+done < "$cases"
+
+if [ $fail -ne 0 ]; then
+    exit 1
+elif [ $run -eq 0 ]; then
+    exit 77
+fi
+exit 0
@@ -24,7 +24,9 @@
 
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "textcache.h"
 #include "tiles16b.h"
 
 
@@ -150,6 +152,13 @@ static const unsigned short TILES[51][16]=
 /* char -> tile índex. */
 static unsigned char _char2tile[256];
 
+/* Atlas: índex de color (0 fons, 1 primer pla 1, 2 primer pla 2, 3
+   res) de cada píxel de cada fila de cada tile. */
+static unsigned char _atlas[51][16][8];
+
+/* Cadenes ja rasteritzades. */
+static textcache_t _cache;
+
 
 
 
@@ -157,41 +166,64 @@ static unsigned char _char2tile[256];
 /* FUNCIONS PRIVADES */
 /*********************/
 
+static void
+init_atlas (void)
+{
+
+  int t, r, c;
+  unsigned short word;
+
+
+  for ( t= 0; t < 51; ++t )
+    for ( r= 0; r < 16; ++r )
+      {
+        word= TILES[t][r];
+        for ( c= 0; c < 8; ++c )
+          {
+            _atlas[t][r][c]= (word&0xC000)>>14;
+            word<<= 2;
+          }
+      }
+
+} /* end init_atlas */
+
+
+/* Si mask no és NULL dibuixa tots els píxels i en 'mask' indica quins
+   s'haurien d'escriure. x i y en píxels. */
 static void
 draw_tile (
-           int       *fb,
-           const int  fb_width,
-           const int  tile,
-           const int  x,
-           const int  y,
-           const int  fgcolor1,
-           const int  fgcolor2,
-           const int  bgcolor,
-           const int  flags
+           int           *fb,
+           unsigned char *mask,
+           const int      fb_width,
+           const int      tile,
+           const int      x,
+           const int      y,
+           const int      colors[4],
+           const int      write[4]
            )
 {
   
-  int offset, r, c;
-  const unsigned short *pat;
-  unsigned short word;
+  int offset, r, c, idx;
+  const unsigned char (*rows)[8];
   
   
-  pat= TILES[tile];
-  offset= !(flags&T16_XY_IN_PIXELS) ? (y*16*fb_width + x*8) : (y*fb_width + x);
+  rows= _atlas[tile];
+  offset= y*fb_width + x;
   for ( r= 0; r < 16; ++r )
     {
-      word= pat[r];
-      for ( c= 0; c < 8; ++c )
-        {
-          switch ( (word&0xC000)>>14 )
-            {
-            case 0: if ( !(flags&T16_BG_TRANS)) fb[offset+c]= bgcolor; break;
-            case 1: if ( !(flags&T16_FG1_TRANS) ) fb[offset+c]= fgcolor1; break;
-            case 2: if ( !(flags&T16_FG2_TRANS) ) fb[offset+c]= fgcolor2; break;
-            default: break;
-            }
-          word<<= 2;
-        }
+      if ( mask != NULL )
+        for ( c= 0; c < 8; ++c )
+          {
+            idx= rows[r][c];
+            fb[offset+c]= colors[idx];
+            mask[offset+c]= write[idx];
+          }
+      else
+        for ( c= 0; c < 8; ++c )
+          {
+            idx= rows[r][c];
+            if ( write[idx] ) fb[offset+c]= colors[idx];
+          }
       offset+= fb_width;
     }
   
@@ -205,33 +237,24 @@ draw_tile_s (
              const int    tile,
              const int    x,
              const int    y,
-             const short  fgcolor1,
-             const short  fgcolor2,
-             const short  bgcolor,
+             const short  colors[4],
+             const int    write[4],
              const int    flags
              )
 {
   
-  int offset, r, c;
-  const unsigned short *pat;
-  unsigned short word;
+  int offset, r, c, idx;
+  const unsigned char (*rows)[8];
   
   
-  pat= TILES[tile];
+  rows= _atlas[tile];
   offset= !(flags&T16_XY_IN_PIXELS) ? (y*16*fb_width + x*8) : (y*fb_width + x);
   for ( r= 0; r < 16; ++r )
     {
-      word= pat[r];
       for ( c= 0; c < 8; ++c )
         {
-          switch ( (word&0xC000)>>14 )
-            {
-            case 0: if ( !(flags&T16_BG_TRANS)) fb[offset+c]= bgcolor; break;
-            case 1: if ( !(flags&T16_FG1_TRANS) ) fb[offset+c]= fgcolor1; break;
-            case 2: if ( !(flags&T16_FG2_TRANS) ) fb[offset+c]= fgcolor2; break;
-            default: break;
-            }
-          word<<= 2;
+          idx= rows[r][c];
+          if ( write[idx] ) fb[offset+c]= colors[idx];
         }
       offset+= fb_width;
     }
@@ -239,6 +262,21 @@ draw_tile_s (
 } /* end draw_tile_s */
 
 
+static void
+get_write (
+           int       write[4],
+           const int flags
+           )
+{
+
+  write[0]= !(flags&T16_BG_TRANS);
+  write[1]= !(flags&T16_FG1_TRANS);
+  write[2]= !(flags&T16_FG2_TRANS);
+  write[3]= 0;
+
+} /* end get_write */
+
+
 
 
 /**********************/
@@ -260,13 +298,33 @@ tiles16b_draw_string (
 {
   
   const char *p;
-  int inc;
+  int colors[4], write[4], key, px, py, i;
+  textcache_entry_t *e;
   
 
-  inc= flags&T16_XY_IN_PIXELS ? 8 : 1;
-  for ( p= string; *p; ++p, x+= inc )
-    draw_tile ( fb, fb_width, _char2tile[(unsigned char) *p],
-        	x, y, fgcolor1, fgcolor2, bgcolor, flags );
+  colors[0]= bgcolor; colors[1]= fgcolor1; colors[2]= fgcolor2; colors[3]= 0;
+  get_write ( write, flags );
+  if ( flags&T16_XY_IN_PIXELS ) { px= x; py= y; }
+  else                          { px= x*8; py= y*16; }
+  key= flags&(T16_FG1_TRANS|T16_FG2_TRANS|T16_BG_TRANS);
+  e= textcache_lookup ( &_cache, string, colors, key );
+  if ( e == NULL )
+    {
+      e= textcache_insert ( &_cache, string, colors, key,
+                            strlen ( string )*8, 16 );
+      if ( e == NULL ) /* Massa llarga. */
+        {
+          for ( p= string; *p; ++p, px+= 8 )
+            draw_tile ( fb, NULL, fb_width, _char2tile[(unsigned char) *p],
+                        px, py, colors, write );
+          return;
+        }
+      for ( p= string, i= 0; *p; ++p, ++i )
+        draw_tile ( e->pix, e->mask, e->width,
+                    _char2tile[(unsigned char) *p], i*8, 0, colors, write );
+      textcache_commit ( e );
+    }
+  textcache_blit ( e, fb, fb_width, px, py );
   
 } /* end tiles16b_draw_string */
 
@@ -286,17 +344,29 @@ tiles16b_draw_string_s (
 {
   
   const char *p;
-  int inc;
+  int inc, write[4];
+  short colors[4];
   
 
+  colors[0]= bgcolor; colors[1]= fgcolor1; colors[2]= fgcolor2; colors[3]= 0;
+  get_write ( write, flags );
   inc= flags&T16_XY_IN_PIXELS ? 8 : 1;
   for ( p= string; *p; ++p, x+= inc )
     draw_tile_s ( fb, fb_width, _char2tile[(unsigned char) *p],
-        	  x, y, fgcolor1, fgcolor2, bgcolor, flags );
+        	  x, y, colors, write, flags );
   
 } /* end tiles16b_draw_string_s */
 
 
+void
+close_tiles16b (void)
+{
+
+  textcache_free ( &_cache );
+  
+} /* end close_tiles16b */
+
+
 void
 init_tiles16b (void)
 {
@@ -321,5 +391,7 @@ init_tiles16b (void)
   _char2tile['-']= 48;
   _char2tile['+']= 49;
   _char2tile['!']= 50;
+  init_atlas ();
+  textcache_init ( &_cache );
   
 } /* end init_tiles16b */
@@ -58,6 +58,9 @@ tiles16b_draw_string_s (
         		const int    flags
         		);
 
+void
+close_tiles16b (void);
+
 void
 init_tiles16b (void);
 
@@ -23,7 +23,9 @@
 
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "textcache.h"
 #include "tiles8b.h"
 
 
@@ -100,6 +102,13 @@ static const unsigned char TILES[52][8]=
 /* char -> tile índex. */
 static unsigned char _char2tile[256];
 
+/* Atlas: índex de color (0 fons, 1 primer pla) de cada píxel de cada
+   fila de cada tile. */
+static unsigned char _atlas[52][8][8];
+
+/* Cadenes ja rasteritzades. */
+static textcache_t _cache;
+
 
 
 
@@ -107,41 +116,64 @@ static unsigned char _char2tile[256];
 /* FUNCIONS PRIVADES */
 /*********************/
 
+static void
+init_atlas (void)
+{
+
+  int t, r, c;
+  unsigned char byte;
+
+
+  for ( t= 0; t < 52; ++t )
+    for ( r= 0; r < 8; ++r )
+      {
+        byte= TILES[t][r];
+        for ( c= 0; c < 8; ++c )
+          {
+            _atlas[t][r][c]= (byte&0x80) ? 1 : 0;
+            byte<<= 1;
+          }
+      }
+
+} /* end init_atlas */
+
+
+/* Si mask no és NULL dibuixa tots els píxels i en 'mask' indica quins
+   s'haurien d'escriure. x i y en píxels. */
 static void
 draw_tile (
-           int       *fb,
-           const int  fb_width,
-           const int  tile,
-           const int  x,
-           const int  y,
-           const int  fgcolor,
-           const int  bgcolor,
-           const int  flags
+           int           *fb,
+           unsigned char *mask,
+           const int      fb_width,
+           const int      tile,
+           const int      x,
+           const int      y,
+           const int      colors[2],
+           const int      write[2]
            )
 {
   
-  int offset, r, c;
-  const unsigned char *pat;
-  unsigned char byte;
+  int offset, r, c, idx;
+  const unsigned char (*rows)[8];
   
   
-  pat= TILES[tile];
-  offset= y*8*fb_width + x*8;
+  rows= _atlas[tile];
+  offset= y*fb_width + x;
   for ( r= 0; r < 8; ++r )
     {
-      byte= pat[r];
-      for ( c= 0; c < 8; ++c )
-        {
-          if ( byte&0x80 )
-            {
-              if ( !(flags&FG_TRANS) ) fb[offset+c]= fgcolor;
-            }
-          else
-            {
-              if ( !(flags&BG_TRANS) ) fb[offset+c]= bgcolor;
-            }
-          byte<<= 1;
-        }
+      if ( mask != NULL )
+        for ( c= 0; c < 8; ++c )
+          {
+            idx= rows[r][c];
+            fb[offset+c]= colors[idx];
+            mask[offset+c]= write[idx];
+          }
+      else
+        for ( c= 0; c < 8; ++c )
+          {
+            idx= rows[r][c];
+            if ( write[idx] ) fb[offset+c]= colors[idx];
+          }
       offset+= fb_width;
     }
   
@@ -153,7 +185,7 @@ draw_tile (
 /**********************/
 /* FUNCIONS PÚBLIQUES */
 /**********************/
-#include <stdio.h>
+
 void
 tiles8b_draw_string (
         	     int        *fb,
@@ -168,15 +200,43 @@ tiles8b_draw_string (
 {
 
   const char *p;
-  
-  
-  for ( p= string; *p; ++p, ++x )
-    draw_tile ( fb, fb_width, _char2tile[(unsigned char) *p],
-        	x, y, fgcolor, bgcolor, flags );
+  int colors[3], write[2], i;
+  textcache_entry_t *e;
+
+
+  colors[0]= bgcolor; colors[1]= fgcolor; colors[2]= 0;
+  write[0]= !(flags&BG_TRANS); write[1]= !(flags&FG_TRANS);
+  e= textcache_lookup ( &_cache, string, colors, flags );
+  if ( e == NULL )
+    {
+      e= textcache_insert ( &_cache, string, colors, flags,
+                            strlen ( string )*8, 8 );
+      if ( e == NULL ) /* Massa llarga. */
+        {
+          for ( p= string; *p; ++p, ++x )
+            draw_tile ( fb, NULL, fb_width, _char2tile[(unsigned char) *p],
+                        x*8, y*8, colors, write );
+          return;
+        }
+      for ( p= string, i= 0; *p; ++p, ++i )
+        draw_tile ( e->pix, e->mask, e->width,
+                    _char2tile[(unsigned char) *p], i*8, 0, colors, write );
+      textcache_commit ( e );
+    }
+  textcache_blit ( e, fb, fb_width, x*8, y*8 );
   
 } /* end tiles8b_draw_string */
 
 
+void
+close_tiles8b (void)
+{
+
+  textcache_free ( &_cache );
+  
+} /* end close_tiles8b */
+
+
 void
 init_tiles8b (void)
 {
@@ -202,5 +262,7 @@ init_tiles8b (void)
   _char2tile['-']= 49;
   _char2tile['+']= 50;
   _char2tile['!']= 51;
+  init_atlas ();
+  textcache_init ( &_cache );
   
 } /* end init_tiles8b */
@@ -42,6 +42,9 @@ tiles8b_draw_string (
         	     const int   flags
         	     );
 
+void
+close_tiles8b (void);
+
 void
 init_tiles8b (void);
 
@@ -29,6 +29,7 @@
 #include <string.h>
 
 #include "error.h"
+#include "textcache.h"
 #include "vgafont.h"
 
 
@@ -556,6 +557,16 @@ static const unsigned char TILES[256][16]=
 
 
 
+/**********/
+/* MACROS */
+/**********/
+
+// Bit privat que distingeix en la memòria cau les cadenes UTF-8.
+#define CACHE_UTF8 0x100
+
+
+
+
 /*********/
 /* ESTAT */
 /*********/
@@ -570,6 +581,13 @@ static struct
   
 } _tocp437;
 
+// Atlas: índex de color (0 fons, 1 primer pla) de cada píxel
+// (inclosa la columna 9) de cada fila de cada caràcter.
+static unsigned char _atlas[256][16][9];
+
+// Cadenes ja convertides i rasteritzades.
+static textcache_t _cache;
+
 
 /*********************/
 /* FUNCIONS PRIVADES */
@@ -639,65 +657,122 @@ to_cp437 (
 } // end to_cp437
 
 
+static void
+init_atlas (void)
+{
+
+  int t, r, c;
+  unsigned char byte;
+
+
+  for ( t= 0; t < 256; ++t )
+    for ( r= 0; r < 16; ++r )
+      {
+        byte= TILES[t][r];
+        for ( c= 0; c < 8; ++c )
+          _atlas[t][r][c]= (byte&(0x80>>c)) ? 1 : 0;
+        // Columna 9 (els caràcters C0-DF repliquen l'última columna
+        // la resta fica el fons)
+        _atlas[t][r][8]= (t >= 0xC0 && t <= 0xDF) ? (byte&0x01) : 0;
+      }
+
+} // end init_atlas
+
+
+// Si mask no és NULL dibuixa tots els píxels i en 'mask' indica
+// quins s'haurien d'escriure. x i y en píxels.
 static void
 draw_tile (
            int                 *fb,
+           unsigned char       *mask,
            const int            fb_width,
            const unsigned char  tile,
            const int            x,
            const int            y,
-           const int            fgcolor,
-           const int            bgcolor,
-           const int            flags
+           const int            colors[2],
+           const int            write[2]
            )
 {
   
-  int offset, r, c;
-  const unsigned char *pat;
-  unsigned char byte,tmp;
+  int offset, r, c, idx;
+  const unsigned char (*rows)[9];
   
   
-  pat= TILES[tile];
-  offset= (flags&VGAFONT_XY_PIXELS)!=0 ? y*fb_width + x : y*16*fb_width + x*9;
+  rows= _atlas[tile];
+  offset= y*fb_width + x;
   for ( r= 0; r < 16; ++r )
     {
-      byte= tmp= pat[r];
-      // Dibuixa caràcter
-      for ( c= 0; c < 8; ++c )
-        {
-          if ( tmp&0x80 )
-            {
-              if ( !(flags&VGAFONT_FG_TRANS) ) fb[offset+c]= fgcolor;
-            }
-          else
-            {
-              if ( !(flags&VGAFONT_BG_TRANS) ) fb[offset+c]= bgcolor;
-            }
-          tmp<<= 1;
-        }
-      // Dibuixa columna 9 (els caràcters C0-DF repliquen l'última
-      // columna la resta fica a fg)
-      if ( tile >= 0xC0 && tile <= 0xDF )
-        {
-          if ( byte&0x01 )
-            {
-              if ( !(flags&VGAFONT_FG_TRANS) ) fb[offset+8]= fgcolor;
-            }
-          else
-            {
-              if ( !(flags&VGAFONT_BG_TRANS) ) fb[offset+8]= bgcolor;
-            }
-        }
+      if ( mask != NULL )
+        for ( c= 0; c < 9; ++c )
+          {
+            idx= rows[r][c];
+            fb[offset+c]= colors[idx];
+            mask[offset+c]= write[idx];
+          }
       else
-        {
-          if ( !(flags&VGAFONT_BG_TRANS) ) fb[offset+8]= bgcolor;
-        }
+        for ( c= 0; c < 9; ++c )
+          {
+            idx= rows[r][c];
+            if ( write[idx] ) fb[offset+c]= colors[idx];
+          }
       offset+= fb_width;
     }
   
 } // end draw_tile
 
 
+// 'key' és el text amb què es guarda en la memòria cau i 'string' el
+// text en CP437 (pot ser NULL si encara no s'ha convertit). Torna la
+// longitut en caràcters de la cadena dibuixada.
+static int
+draw_string (
+             int        *fb,
+             const int   fb_width,
+             const char *key,
+             const char *string,
+             int         x,
+             int         y,
+             const int   fgcolor,
+             const int   bgcolor,
+             const int   flags,
+             const int   kflags
+             )
+{
+
+  const char *p;
+  int colors[3], write[2], i, len;
+  textcache_entry_t *e;
+
+
+  colors[0]= bgcolor; colors[1]= fgcolor; colors[2]= 0;
+  write[0]= !(flags&VGAFONT_BG_TRANS); write[1]= !(flags&VGAFONT_FG_TRANS);
+  if ( !(flags&VGAFONT_XY_PIXELS) ) { x*= 9; y*= 16; }
+  e= textcache_lookup ( &_cache, key, colors, kflags );
+  if ( e == NULL )
+    {
+      if ( string == NULL ) string= to_cp437 ( key, &len );
+      else                  len= strlen ( string );
+      e= textcache_insert ( &_cache, key, colors, kflags, len*9, 16 );
+      if ( e == NULL ) // Massa llarga.
+        {
+          for ( p= string; *p; ++p, x+= 9 )
+            draw_tile ( fb, NULL, fb_width, (unsigned char) *p,
+                        x, y, colors, write );
+          return len;
+        }
+      for ( p= string, i= 0; *p; ++p, ++i )
+        draw_tile ( e->pix, e->mask, e->width, (unsigned char) *p,
+                    i*9, 0, colors, write );
+      textcache_commit ( e );
+      e->nchars= len;
+    }
+  textcache_blit ( e, fb, fb_width, x, y );
+
+  return e->nchars;
+
+} // end draw_string
+
+
 
 
 /**********************/
@@ -707,6 +782,7 @@ draw_tile (
 void
 close_vgafont (void)
 {
+  textcache_free ( &_cache );
   close_tocp437 ();
 } // end close_vgafont
 
@@ -715,6 +791,8 @@ void
 init_vgafont (void)
 {
   init_tocp437 ();
+  init_atlas ();
+  textcache_init ( &_cache );
 } // end init_vgafont
 
 
@@ -730,16 +808,8 @@ vgafont_draw_string (
                      const int   flags
                      )
 {
-
-  const char *p;
-  int inc;
-
-
-  inc= flags&VGAFONT_XY_PIXELS ? 9 : 1;
-  for ( p= string; *p; ++p, x+= inc )
-    draw_tile ( fb, fb_width, (unsigned char) *p,
-                x, y, fgcolor, bgcolor, flags );
-  
+  draw_string ( fb, fb_width, string, string, x, y, fgcolor, bgcolor,
+                flags, flags&(VGAFONT_FG_TRANS|VGAFONT_BG_TRANS) );
 } // end vgafont_draw_string
 
 
@@ -756,14 +826,8 @@ vgafont_draw_string_utf8 (
                           )
 {
 
-  const char *tmp;
-  int ret;
-  
-
-  tmp= to_cp437 ( string, &ret );
-  vgafont_draw_string ( fb, fb_width, tmp,
-                        x, y, fgcolor, bgcolor, flags );
-
-  return ret;
+  return draw_string ( fb, fb_width, string, NULL, x, y, fgcolor, bgcolor,
+                       flags,
+                       (flags&(VGAFONT_FG_TRANS|VGAFONT_BG_TRANS))|CACHE_UTF8 );
   
 } // end vgafont_draw_string_utf8